@@ -44,6 +44,92 @@ extern "C" {
 #define ZONE_NOT_A_FILE (-(7<<8))
 /** Access to specified file is not allowed */
 #define ZONE_NOT_PERMITTED (-(8<<8))
+/** Zone image is corrupt or of an unsupported version */
+#define ZONE_BAD_IMAGE (-(9<<8))
+/** @} */
+
+/**
+ * @defgroup class_codes Class codes
+ *
+ * @{
+ */
+/** Internet */
+#define ZONE_IN (1)
+/** CSNET (obsolete) */
+#define ZONE_CS (2)
+/** CHAOS */
+#define ZONE_CH (3)
+/** Hesiod */
+#define ZONE_HS (4)
+/** @} */
+
+/**
+ * @defgroup type_codes Type codes
+ *
+ * @{
+ */
+#define ZONE_A (1)
+#define ZONE_NS (2)
+#define ZONE_MD (3)
+#define ZONE_MF (4)
+#define ZONE_CNAME (5)
+#define ZONE_SOA (6)
+#define ZONE_MB (7)
+#define ZONE_MG (8)
+#define ZONE_MR (9)
+#define ZONE_NULL (10)
+#define ZONE_WKS (11)
+#define ZONE_PTR (12)
+#define ZONE_HINFO (13)
+#define ZONE_MINFO (14)
+#define ZONE_MX (15)
+#define ZONE_TXT (16)
+#define ZONE_RP (17)
+#define ZONE_AFSDB (18)
+#define ZONE_X25 (19)
+#define ZONE_ISDN (20)
+#define ZONE_RT (21)
+#define ZONE_SIG (24)
+#define ZONE_KEY (25)
+#define ZONE_PX (26)
+#define ZONE_AAAA (28)
+#define ZONE_LOC (29)
+#define ZONE_NXT (30)
+#define ZONE_SRV (33)
+#define ZONE_NAPTR (35)
+#define ZONE_KX (36)
+#define ZONE_CERT (37)
+#define ZONE_DNAME (39)
+#define ZONE_APL (42)
+#define ZONE_DS (43)
+#define ZONE_SSHFP (44)
+#define ZONE_IPSECKEY (45)
+#define ZONE_RRSIG (46)
+#define ZONE_NSEC (47)
+#define ZONE_DNSKEY (48)
+#define ZONE_DHCID (49)
+#define ZONE_NSEC3 (50)
+#define ZONE_NSEC3PARAM (51)
+#define ZONE_TLSA (52)
+#define ZONE_SMIMEA (53)
+#define ZONE_HIP (55)
+#define ZONE_CDS (59)
+#define ZONE_CDNSKEY (60)
+#define ZONE_OPENPGPKEY (61)
+#define ZONE_CSYNC (62)
+#define ZONE_ZONEMD (63)
+#define ZONE_SVCB (64)
+#define ZONE_HTTPS (65)
+#define ZONE_SPF (99)
+#define ZONE_NID (104)
+#define ZONE_L32 (105)
+#define ZONE_L64 (106)
+#define ZONE_LP (107)
+#define ZONE_EUI48 (108)
+#define ZONE_EUI64 (109)
+#define ZONE_URI (256)
+#define ZONE_CAA (257)
+#define ZONE_DLV (32769)
 /** @} */
 
 
@@ -52,6 +138,14 @@ extern "C" {
 /** @private */
 #define ZONE_WINDOW_SIZE (256 * ZONE_BLOCK_SIZE) // 16KB
 
+/**
+ * @private
+ *
+ * Number of octets windows are padded with. Kernels load fixed-size vectors
+ * from the input without checking for the end of the input first.
+ */
+#define ZONE_PADDING_SIZE (ZONE_BLOCK_SIZE)
+
  /* (based on experiments, 6 seems decent).*/
 #define ZONE_BLOCK_INDEXES (5)
 
@@ -91,6 +185,15 @@ struct zone_buffers {
   size_t size; /**< Number of name and RDATA buffers available */
   zone_name_buffer_t *owner;
   zone_rdata_buffer_t *rdata;
+  /** Optional append-only arena to pack RDATA back-to-back. */
+  /** RDATA is stored with exact lengths. Records whose maximum RDATA length
+      does not fit the arena are parsed into a single overflow buffer
+      (rdata) and moved into the arena if they do fit after all. size
+      specifies the number of owner buffers available in arena mode. */
+  struct {
+    size_t size; /**< Size of arena in octets */
+    uint8_t *octets;
+  } arena;
 };
 
 // line feeds are tracked for error reporting. RFC1035 section 5.1 states
@@ -107,14 +210,28 @@ struct zone_index {
 typedef struct zone_file zone_file_t;
 struct zone_file {
   zone_file_t *includer;
-  zone_name_buffer_t origin, owner;
+  zone_name_buffer_t origin;
+  /** Owner of the last record, saved on $INCLUDE and restored once the
+      included file is done (RFC 1035 section 5.1). */
+  zone_name_buffer_t owner;
   uint16_t last_type;
   uint16_t last_class;
   uint32_t last_ttl, default_ttl;
+  /** Records that omit the TTL use default_ttl if a $TTL directive was
+      seen and the last stated TTL otherwise (RFC 2308 section 4). */
+  bool have_default_ttl;
   size_t line;
   const char *name;
   const char *path;
   FILE *handle;
+  struct {
+    size_t index, length;
+    const char *data;
+  } string; /**< String input, read if there is no handle */
+  struct {
+    size_t size;
+    char *data;
+  } paths; /**< Storage for name and path, retained by reusable parsers */
   bool grouped;
   bool start_of_line;
   enum { ZONE_HAVE_DATA, ZONE_READ_ALL_DATA, ZONE_NO_MORE_DATA } end_of_file;
@@ -220,6 +337,71 @@ typedef int32_t(*zone_add_t)(
   const uint8_t *, // rdata
   void *); // user data
 
+typedef void *(*zone_malloc_t)(
+  void *, // arena
+  size_t); // size
+
+typedef void *(*zone_realloc_t)(
+  void *, // arena
+  void *, // pointer
+  size_t); // size
+
+typedef void(*zone_free_t)(
+  void *, // arena
+  void *); // pointer
+
+/**
+ * @brief Allocator used for all memory the parser allocates
+ *
+ * Allows for backing the parser with e.g. per-thread arenas or a slab
+ * allocator and for enforcing a memory budget per load. Callbacks must
+ * either all be set or all be unset, in which case the C library functions
+ * are used.
+ */
+typedef struct zone_allocator zone_allocator_t;
+struct zone_allocator {
+  zone_malloc_t malloc;
+  zone_realloc_t realloc;
+  zone_free_t free;
+  /** Passed verbatim to each callback. */
+  void *arena;
+};
+
+typedef struct zone_record zone_record_t;
+struct zone_record {
+  zone_name_t owner;
+  uint16_t type;
+  uint16_t class;
+  uint32_t ttl;
+  uint16_t rdlength;
+  const uint8_t *rdata;
+};
+
+// invoked for each batch of records (host order). owner and rdata reference
+// the name and rdata buffers, records that share an owner reference the
+// same name buffer. buffers are reused after the callback returns. pending
+// records are delivered before an error is returned
+typedef int32_t(*zone_batch_t)(
+  zone_parser_t *,
+  const zone_record_t *, // records
+  size_t, // number of records
+  void *); // user data
+
+/**
+ * @brief Growable output arena for wire-format records
+ *
+ * Records are appended as contiguous wire-format resource records (owner,
+ * type, class, ttl, rdlength and rdata, in network order) without invoking
+ * a callback per record. The arena is grown by the parser using the
+ * allocator specified in the options, the caller owns the memory.
+ */
+typedef struct zone_stream zone_stream_t;
+struct zone_stream {
+  size_t size; /**< Number of octets allocated */
+  size_t length; /**< Number of octets used */
+  uint8_t *octets;
+};
+
 typedef struct zone_options zone_options_t;
 struct zone_options {
   /** Lax mode of operation. */
@@ -232,9 +414,15 @@ struct zone_options {
   bool no_includes;
   /** Enable 1h2m3s notation for TTLs. */
   bool friendly_ttls;
+  /** Convert domain names to canonical form (RFC 4034 section 6.2). */
+  /** Owners and names in RDATA of the types listed in section 6.2, minus
+      NSEC (RFC 6840 section 5.1), are converted to lower case as they are
+      parsed. Other names, e.g. SVCB TargetName, are left as is. */
+  bool canonical;
   const char *origin;
   uint32_t default_ttl;
   uint16_t default_class;
+  zone_allocator_t allocator;
   struct {
     /** Message categories to write out. */
     /** All categories are printed if no categories are selected and no
@@ -245,6 +433,14 @@ struct zone_options {
   } log;
   struct {
     zone_add_t add;
+    /** Deliver records in batches, mutually exclusive with add. */
+    zone_batch_t batch;
+    /** Number of records per batch. */
+    /** Defaults to, and cannot exceed, the number of buffers. */
+    size_t batch_size;
+    /** Append records in wire format, mutually exclusive with add and
+        batch. */
+    zone_stream_t *stream;
     // FIXME: more callbacks to be added at a later stage to support efficient
     //        (de)serialization of AXFR/IXFR in text representation.
     //zone_delete_t remove;
@@ -265,9 +461,49 @@ struct zone_parser {
       size_t index;
       zone_rdata_buffer_t *buffers;
     } rdata;
+    struct {
+      size_t size, length;
+      uint8_t *octets;
+    } arena;
   } buffers;
   zone_name_buffer_t *owner;
-  zone_rdata_buffer_t *rdata;
+  /** Set for records that omit the owner and for records that state the
+      same owner as the previous record. Valid for the duration of the
+      callback, consumers may skip hashing or lookup of the owner. */
+  bool same_owner;
+  /** @private Owner reverted on return from an included file. */
+  bool reverted_owner;
+  /** Text of the last owner, compared to skip conversion of repeated
+      owners. Empty if the text contained escape sequences or if the origin
+      may have changed. */
+  struct {
+    int32_t code;
+    size_t length;
+    char data[ 255 + ZONE_BLOCK_SIZE /* padding */ ];
+  } last_owner;
+  /** RDATA of current record, references buffer, arena or overflow. */
+  struct {
+    size_t length;
+    uint8_t *octets;
+  } rdata;
+  struct {
+    size_t size; /**< Number of records per batch */
+    size_t length; /**< Number of records in batch */
+    size_t capacity; /**< Number of records allocated */
+    zone_record_t *records;
+  } batch;
+  struct {
+    /** Retain allocations on close, set for parsers created with
+        zone_parser_create. */
+    bool retain;
+    /** Window of the first file, which is not allocated on string input. */
+    struct {
+      size_t size;
+      char *data;
+    } window;
+    /** Idle include files, linked by includer, with window and paths. */
+    zone_file_t *files;
+  } cache;
   zone_file_t *file, first;
 };
 
@@ -285,6 +521,9 @@ zone_nonnull((1,2,3,4));
 
 /**
  * @brief Parse zone from string
+ *
+ * @p string is read into a window like a file, it need not be padded nor
+ * null-terminated and is never read beyond @p length.
  */
 ZONE_EXPORT int32_t
 zone_parse_string(
@@ -296,6 +535,170 @@ zone_parse_string(
   void *user_data)
 zone_nonnull((1,2,3,4));
 
+/**
+ * @brief Create parser that retains allocations across parses
+ *
+ * Parsing many small zones with #zone_parse is dominated by fixed overhead,
+ * i.e. allocating (and initializing) the window, tape and paths. A parser
+ * created with #zone_parser_create keeps these allocations warm between
+ * calls to #zone_parser_parse and #zone_parser_parse_string. Retained
+ * allocations are released if a parse specifies a different allocator.
+ *
+ * @note The parser itself is allocated using malloc.
+ *
+ * @returns Parser or NULL if memory could not be allocated.
+ */
+ZONE_EXPORT zone_parser_t *
+zone_parser_create(void);
+
+/**
+ * @brief Reset parser, close open files and retain allocations
+ *
+ * Invoked implicitly by #zone_parser_parse and #zone_parser_parse_string.
+ */
+ZONE_EXPORT void
+zone_parser_reset(zone_parser_t *parser)
+zone_nonnull_all();
+
+/**
+ * @brief Destroy parser and release retained allocations
+ */
+ZONE_EXPORT void
+zone_parser_destroy(zone_parser_t *parser);
+
+/**
+ * @brief Parse zone from file using parser created with #zone_parser_create
+ */
+ZONE_EXPORT int32_t
+zone_parser_parse(
+  zone_parser_t *parser,
+  const zone_options_t *options,
+  zone_buffers_t *buffers,
+  const char *path,
+  void *user_data)
+zone_nonnull((1,2,3,4));
+
+/**
+ * @brief Parse zone from string using parser created with #zone_parser_create
+ */
+ZONE_EXPORT int32_t
+zone_parser_parse_string(
+  zone_parser_t *parser,
+  const zone_options_t *options,
+  zone_buffers_t *buffers,
+  const char *string,
+  size_t length,
+  void *user_data)
+zone_nonnull((1,2,3,4));
+
+/**
+ * @defgroup image Zone images
+ *
+ * A zone image is a versioned binary representation of a parsed zone that
+ * can be memory mapped at startup instead of parsing the zone again. Owner
+ * names are stored in canonical order (RFC4034 section 6.1), each with its
+ * RRsets ordered by type and the RDATA of each RRset in canonical order.
+ * Names and RRsets are indexed by offset so that lookups operate directly
+ * on the mapping. The text representation remains the source of truth.
+ *
+ * Images are created by passing #zone_image_add as accept.add callback
+ * with the writer as user data and writing the image once the zone has
+ * been parsed. Integers are stored in host order, images are not portable
+ * across platforms with a different byte order.
+ *
+ * @{
+ */
+typedef struct zone_image_writer zone_image_writer_t;
+typedef struct zone_image zone_image_t;
+
+typedef struct zone_rrset zone_rrset_t;
+struct zone_rrset {
+  size_t owner_length;
+  const uint8_t *owner;
+  uint16_t type;
+  uint16_t class;
+  uint32_t ttl;
+  size_t count; /**< Number of records in RRset */
+  /** RDATA of each record, prefixed by its length (2 octets, host order) */
+  const uint8_t *rdata;
+};
+
+/**
+ * @brief Create image writer
+ *
+ * @returns Image writer or NULL if memory could not be allocated.
+ */
+ZONE_EXPORT zone_image_writer_t *
+zone_image_writer_create(void);
+
+/**
+ * @brief Destroy image writer
+ */
+ZONE_EXPORT void
+zone_image_writer_destroy(zone_image_writer_t *writer);
+
+/**
+ * @brief Add record to image writer (#zone_add_t compatible)
+ *
+ * Duplicate records are dropped, RRsets take the lowest TTL.
+ *
+ * @param[in]  user_data  Image writer
+ */
+ZONE_EXPORT int32_t
+zone_image_add(
+  zone_parser_t *parser,
+  const zone_name_t *owner,
+  uint16_t type,
+  uint16_t class,
+  uint32_t ttl,
+  uint16_t rdlength,
+  const uint8_t *rdata,
+  void *user_data)
+zone_nonnull((2,8));
+
+/**
+ * @brief Write image of records added so far to file
+ */
+ZONE_EXPORT int32_t
+zone_image_write(zone_image_writer_t *writer, const char *path)
+zone_nonnull_all();
+
+/**
+ * @brief Map image into memory
+ *
+ * Names and the index are verified once, #ZONE_BAD_IMAGE is returned if
+ * the image is corrupt.
+ */
+ZONE_EXPORT int32_t
+zone_image_open(zone_image_t **image, const char *path)
+zone_nonnull_all();
+
+/**
+ * @brief Unmap image
+ */
+ZONE_EXPORT void
+zone_image_close(zone_image_t *image);
+
+/**
+ * @brief Find RRset by owner (wire format) and type
+ *
+ * Owner names are compared case-insensitively. RRset references the
+ * mapping and remains valid until the image is closed.
+ *
+ * @returns Number of records in RRset, 0 if no RRset exists,
+ *          #ZONE_BAD_PARAMETER if owner is not a valid name or
+ *          #ZONE_BAD_IMAGE if the image is corrupt.
+ */
+ZONE_EXPORT int32_t
+zone_image_lookup(
+  const zone_image_t *image,
+  const uint8_t *owner,
+  size_t length,
+  uint16_t type,
+  zone_rrset_t *rrset)
+zone_nonnull_all();
+/** @} */
+
 // zone_parse_axfr
 // zone_parse_ixfr
 
@@ -0,0 +1,232 @@
+/*
+ * accept.h -- deliver parsed records to the application
+ *
+ * Copyright (c) 2023, NLnet Labs. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#ifndef ACCEPT_H
+#define ACCEPT_H
+
+#include <string.h>
+
+#include "zone.h"
+#include "log.h"
+#include "heap.h"
+
+// records in a batch reference the owner and rdata buffers. rdata is parsed
+// into the buffer that matches the slot in the batch, owners are parsed into
+// a new buffer only if the current owner is referenced by a pending record.
+// every record references at most one distinct owner buffer, hence the
+// number of owner buffers required is equal to the batch size.
+//
+// in arena mode rdata is packed back-to-back in the arena instead. rdata is
+// parsed into the arena if the maximum length for the type fits, into the
+// overflow buffer otherwise and moved into the arena afterwards if it fits.
+// the overflow buffer is referenced by at most one pending record
+// (buffers.rdata.index is used to track that).
+
+zone_nonnull_all()
+static zone_inline void reset_rdata(zone_parser_t *parser)
+{
+  parser->buffers.rdata.index = 0;
+  parser->buffers.arena.length = 0;
+  if (!parser->buffers.arena.octets)
+    parser->rdata.octets = parser->buffers.rdata.buffers[0].octets;
+}
+
+zone_nonnull((1))
+static inline int32_t flush_batch(zone_parser_t *parser, void *user_data)
+{
+  int32_t result = 0;
+  const size_t length = parser->batch.length;
+
+  parser->batch.length = 0;
+  reset_rdata(parser);
+  if (length)
+    result = parser->options.accept.batch(
+      parser, parser->batch.records, length, user_data);
+  return result < 0 ? result : 0;
+}
+
+// select buffer to scan next owner into
+zone_nonnull_all()
+static zone_inline zone_name_buffer_t *claim_owner(zone_parser_t *parser)
+{
+  const size_t length = parser->batch.length;
+
+  if (length && parser->batch.records[length - 1].owner.octets == parser->owner->octets) {
+    size_t index = parser->buffers.owner.index + 1;
+    index = index == parser->batch.size ? 0 : index;
+    parser->buffers.owner.index = index;
+    parser->owner = &parser->buffers.owner.buffers[index];
+  }
+
+  return parser->owner;
+}
+
+zone_nonnull((1))
+static zone_no_inline int32_t claim_overflow(
+  zone_parser_t *parser, size_t bound, void *user_data)
+{
+  int32_t result;
+
+  // overflow buffer may be referenced by a pending record
+  if (bound + ZONE_BLOCK_SIZE > parser->buffers.arena.size) {
+    if (parser->buffers.rdata.index && (result = flush_batch(parser, user_data)))
+      return result;
+    parser->rdata.octets = parser->buffers.rdata.buffers[0].octets;
+    return 0;
+  }
+
+  // arena is full
+  if ((result = flush_batch(parser, user_data)))
+    return result;
+  parser->rdata.octets = parser->buffers.arena.octets;
+  return 0;
+}
+
+// in stream mode records are appended in wire format. the owner is copied
+// and rdata is parsed in place, the fixed fields are written on accept
+#define RR_FIXED_SIZE (10) // type, class, ttl and rdlength
+
+zone_nonnull_all()
+static zone_no_inline int32_t grow_stream(zone_parser_t *parser, size_t size)
+{
+  zone_stream_t *stream = parser->options.accept.stream;
+  uint8_t *octets;
+
+  if (size < 2 * stream->size)
+    size = 2 * stream->size;
+  if (!(octets = zone_realloc(parser, stream->octets, size)))
+    OUT_OF_MEMORY(parser);
+  stream->size = size;
+  stream->octets = octets;
+  return 0;
+}
+
+zone_nonnull_all()
+static zone_inline int32_t claim_stream(zone_parser_t *parser, size_t bound)
+{
+  int32_t result;
+  zone_stream_t *stream = parser->options.accept.stream;
+  const size_t size =
+    stream->length + parser->owner->length + RR_FIXED_SIZE + bound + ZONE_BLOCK_SIZE;
+
+  if (zone_unlikely(size > stream->size) && (result = grow_stream(parser, size)))
+    return result;
+
+  uint8_t *octets = stream->octets + stream->length;
+  memcpy(octets, parser->owner->octets, parser->owner->length);
+  parser->rdata.octets = octets + parser->owner->length + RR_FIXED_SIZE;
+  return 0;
+}
+
+zone_nonnull_all()
+static zone_inline void append_rr(zone_parser_t *parser)
+{
+  const zone_file_t *file = parser->file;
+  zone_stream_t *stream = parser->options.accept.stream;
+  uint8_t *octets = stream->octets + stream->length + parser->owner->length;
+
+  octets[0] = (uint8_t)(file->last_type >> 8);
+  octets[1] = (uint8_t)(file->last_type);
+  octets[2] = (uint8_t)(file->last_class >> 8);
+  octets[3] = (uint8_t)(file->last_class);
+  octets[4] = (uint8_t)(file->last_ttl >> 24);
+  octets[5] = (uint8_t)(file->last_ttl >> 16);
+  octets[6] = (uint8_t)(file->last_ttl >> 8);
+  octets[7] = (uint8_t)(file->last_ttl);
+  octets[8] = (uint8_t)(parser->rdata.length >> 8);
+  octets[9] = (uint8_t)(parser->rdata.length);
+  stream->length += parser->owner->length + RR_FIXED_SIZE + parser->rdata.length;
+}
+
+// select buffer to parse rdata into, bound is the maximum rdata length for
+// the type of record
+zone_nonnull((1))
+static zone_inline int32_t claim_rdata(
+  zone_parser_t *parser, size_t bound, void *user_data)
+{
+  parser->rdata.length = 0;
+  if (parser->options.accept.stream)
+    return claim_stream(parser, bound);
+  if (!parser->buffers.arena.octets)
+    return 0;
+  const size_t available =
+    parser->buffers.arena.size - parser->buffers.arena.length;
+  if (zone_unlikely(bound + ZONE_BLOCK_SIZE > available))
+    return claim_overflow(parser, bound, user_data);
+  parser->rdata.octets = parser->buffers.arena.octets + parser->buffers.arena.length;
+  return 0;
+}
+
+zone_nonnull_all()
+static zone_no_inline void spill_rdata(zone_parser_t *parser)
+{
+  const size_t available =
+    parser->buffers.arena.size - parser->buffers.arena.length;
+
+  if (parser->rdata.length > available) {
+    parser->buffers.rdata.index = 1;
+    return;
+  }
+
+  uint8_t *octets = parser->buffers.arena.octets + parser->buffers.arena.length;
+  memcpy(octets, parser->rdata.octets, parser->rdata.length);
+  parser->rdata.octets = octets;
+  parser->buffers.arena.length += parser->rdata.length;
+}
+
+zone_nonnull((1))
+static zone_inline int32_t accept_rr(zone_parser_t *parser, void *user_data)
+{
+  const zone_file_t *file = parser->file;
+
+  if (parser->options.accept.stream) {
+    append_rr(parser);
+    return 0;
+  }
+
+  if (parser->buffers.arena.octets) {
+    if (zone_unlikely(parser->rdata.octets == parser->buffers.rdata.buffers[0].octets))
+      spill_rdata(parser);
+    else
+      parser->buffers.arena.length += parser->rdata.length;
+  }
+
+  if (!parser->options.accept.batch) {
+    const int32_t result = parser->options.accept.add(
+      parser,
+      &(zone_name_t){ (uint8_t)parser->owner->length, parser->owner->octets },
+      file->last_type,
+      file->last_class,
+      file->last_ttl,
+      (uint16_t)parser->rdata.length,
+      parser->rdata.octets,
+      user_data);
+    reset_rdata(parser);
+    return result < 0 ? result : 0;
+  }
+
+  zone_record_t *record = &parser->batch.records[parser->batch.length++];
+  record->owner.length = (uint8_t)parser->owner->length;
+  record->owner.octets = parser->owner->octets;
+  record->type = file->last_type;
+  record->class = file->last_class;
+  record->ttl = file->last_ttl;
+  record->rdlength = (uint16_t)parser->rdata.length;
+  record->rdata = parser->rdata.octets;
+
+  if (parser->batch.length == parser->batch.size)
+    return flush_batch(parser, user_data);
+
+  if (!parser->buffers.arena.octets) {
+    parser->buffers.rdata.index = parser->batch.length;
+    parser->rdata.octets = parser->buffers.rdata.buffers[parser->batch.length].octets;
+  }
+  return 0;
+}
+
+#endif // ACCEPT_H
@@ -0,0 +1,76 @@
+/*
+ * apl.h -- parse address prefix lists (RFC 3123)
+ *
+ * Copyright (c) 2023, NLnet Labs. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#ifndef APL_H
+#define APL_H
+
+#define APL_IP4 (1)
+#define APL_IP6 (2)
+
+// [!]afi:address/prefix items that make up the remainder of the RDATA, the
+// list may be empty. trailing zero octets of each address are omitted
+// (RFC 3123 section 4). consumes all tokens, token is the delimiter on
+// return
+zone_nonnull_all()
+static zone_inline int32_t parse_apl(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  uint8_t *wire = parser->rdata.octets + parser->rdata.length;
+  const uint8_t *limit = parser->rdata.octets + 65535;
+
+  while (token->code == CONTIGUOUS) {
+    const char *data = token->data;
+    uint64_t prefix;
+    uint16_t family;
+    size_t length, count;
+
+    if (wire + 4 + 16 > limit)
+      return rdata_too_long(parser, type, field);
+
+    const uint8_t negate = *data == '!' ? 0x80 : 0x00;
+    data += negate != 0;
+    if (data[1] != ':')
+      return invalid_field(parser, type, field);
+    if (data[0] == '0' + APL_IP4) {
+      if (!scan_ip4(data + 2, wire + 4, &length))
+        return invalid_field(parser, type, field);
+      family = APL_IP4;
+      count = 4;
+    } else if (data[0] == '0' + APL_IP6) {
+      if (!scan_ip6(data + 2, wire + 4, &length))
+        return invalid_field(parser, type, field);
+      family = APL_IP6;
+      count = 16;
+    } else {
+      return invalid_field(parser, type, field);
+    }
+
+    data += 2 + length;
+    if (*data++ != '/')
+      return invalid_field(parser, type, field);
+    length = scan_number(data, &prefix);
+    if (!length || is_contiguous(data + length) || prefix > count * 8)
+      return invalid_field(parser, type, field);
+
+    while (count && !wire[4 + count - 1])
+      count--;
+    write_int16(wire, family);
+    wire[2] = (uint8_t)prefix;
+    wire[3] = negate | (uint8_t)count;
+    wire += 4 + count;
+    lex(parser, token);
+  }
+
+  parser->rdata.length = (size_t)(wire - parser->rdata.octets);
+  return 0;
+}
+
+#endif // APL_H
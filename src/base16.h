@@ -0,0 +1,150 @@
+/*
+ * base16.h -- parse hexadecimal fields
+ *
+ * Copyright (c) 2023, NLnet Labs. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#ifndef BASE16_H
+#define BASE16_H
+
+// 0x00 - 0x0f for hexadecimal digits, 0xff otherwise
+static const uint8_t base16_table[256] = {
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+
+// decode 32 hexadecimal digits to 16 octets if all digits are valid
+zone_nonnull_all()
+static zone_inline bool decode_base16_block(const char *data, uint8_t *wire)
+{
+  const __m256i input = _mm256_loadu_si256((const __m256i *)data);
+  const __m256i digits = _mm256_sub_epi8(input, _mm256_set1_epi8('0'));
+  const __m256i letters = _mm256_sub_epi8(
+    _mm256_or_si256(input, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+  const __m256i is_digit = _mm256_cmpeq_epi8(
+    _mm256_min_epu8(digits, _mm256_set1_epi8(9)), digits);
+  const __m256i is_letter = _mm256_cmpeq_epi8(
+    _mm256_min_epu8(letters, _mm256_set1_epi8(5)), letters);
+  if (_mm256_movemask_epi8(_mm256_or_si256(is_digit, is_letter)) != -1)
+    return false;
+
+  const __m256i nibbles = _mm256_blendv_epi8(
+    _mm256_add_epi8(letters, _mm256_set1_epi8(10)), digits, is_digit);
+  // high nibble times 16 plus low nibble, then narrow to octets
+  const __m256i pairs = _mm256_maddubs_epi16(nibbles, _mm256_set1_epi16(0x0110));
+  const __m256i octets = _mm256_permute4x64_epi64(
+    _mm256_packus_epi16(pairs, pairs), 0x08);
+  _mm_storeu_si128((__m128i *)wire, _mm256_castsi256_si128(octets));
+  return true;
+}
+
+// hexadecimal digits that make up the remainder of the RDATA, whitespace is
+// allowed (RFC 4034 section 5.3). consumes all tokens, token is the
+// delimiter on return
+zone_nonnull_all()
+static zone_inline int32_t parse_base16(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  int32_t code;
+  uint32_t state = 0;
+  uint8_t *wire = parser->rdata.octets + parser->rdata.length;
+  const uint8_t *limit = parser->rdata.octets + 65535;
+
+  if ((code = have_contiguous(parser, type, field, token)) < 0)
+    return code;
+
+  do {
+    const char *data = token->data;
+    if (state == 0) {
+      while (wire + 16 <= limit && decode_base16_block(data, wire)) {
+        data += 32;
+        wire += 16;
+      }
+    }
+
+    for (uint8_t digit; (digit = base16_table[(uint8_t)*data]) != 0xff; data++) {
+      if (state) {
+        *wire++ |= digit;
+        if (wire > limit)
+          return rdata_too_long(parser, type, field);
+      } else {
+        *wire = (uint8_t)(digit << 4);
+      }
+      state ^= 1;
+    }
+    if (is_contiguous(data))
+      return invalid_field(parser, type, field);
+    lex(parser, token);
+  } while (token->code == CONTIGUOUS);
+
+  if (state)
+    return invalid_field(parser, type, field);
+  parser->rdata.length = (size_t)(wire - parser->rdata.octets);
+  return 0;
+}
+
+// hexadecimal string prefixed by its length or "-" if empty, e.g. NSEC3
+// salt (RFC 5155 section 3.3)
+zone_nonnull_all()
+static zone_inline int32_t parse_salt(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  int32_t code;
+  uint8_t *octets = parser->rdata.octets + parser->rdata.length;
+  const char *data = token->data;
+  size_t length = 0;
+
+  if ((code = have_contiguous(parser, type, field, token)) < 0)
+    return code;
+
+  if (data[0] == '-' && !is_contiguous(data + 1)) {
+    octets[0] = 0;
+    parser->rdata.length += 1;
+    return 0;
+  }
+
+  while (length + 16 <= 255 && decode_base16_block(data, octets + 1 + length)) {
+    data += 32;
+    length += 16;
+  }
+
+  for (;; data += 2) {
+    const uint8_t d0 = base16_table[(uint8_t)data[0]];
+    if (d0 == 0xff)
+      break;
+    const uint8_t d1 = base16_table[(uint8_t)data[1]];
+    if (d1 == 0xff || length == 255)
+      return invalid_field(parser, type, field);
+    octets[++length] = (uint8_t)((d0 << 4) | d1);
+  }
+
+  if (!length || is_contiguous(data))
+    return invalid_field(parser, type, field);
+  octets[0] = (uint8_t)length;
+  parser->rdata.length += 1 + length;
+  return 0;
+}
+
+#endif // BASE16_H
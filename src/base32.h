@@ -0,0 +1,107 @@
+/*
+ * base32.h -- parse base32hex fields
+ *
+ * Copyright (c) 2023, NLnet Labs. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#ifndef BASE32_H
+#define BASE32_H
+
+// base32hex alphabet (RFC 4648 section 7), case insensitive
+static const uint8_t base32_table[256] = {
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18,
+  0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18,
+  0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+
+// decode 32 base32hex digits to 20 octets if all digits are valid. each
+// 64-bit lane holds eight digits, which are merged into 40 bits with
+// multiply-add. 32 octets are written, the buffer must be padded
+zone_nonnull_all()
+static zone_inline bool decode_base32_block(const char *data, uint8_t *wire)
+{
+  const __m256i input = _mm256_loadu_si256((const __m256i *)data);
+  const __m256i digits = _mm256_sub_epi8(input, _mm256_set1_epi8('0'));
+  const __m256i letters = _mm256_sub_epi8(
+    _mm256_or_si256(input, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+  const __m256i is_digit = _mm256_cmpeq_epi8(
+    _mm256_min_epu8(digits, _mm256_set1_epi8(9)), digits);
+  const __m256i is_letter = _mm256_cmpeq_epi8(
+    _mm256_min_epu8(letters, _mm256_set1_epi8(21)), letters);
+  if (_mm256_movemask_epi8(_mm256_or_si256(is_digit, is_letter)) != -1)
+    return false;
+
+  const __m256i values = _mm256_blendv_epi8(
+    _mm256_add_epi8(letters, _mm256_set1_epi8(10)), digits, is_digit);
+  // 2 x 5 bits to 10 bits, 2 x 10 bits to 20 bits, 2 x 20 bits to 40 bits
+  const __m256i pairs = _mm256_maddubs_epi16(values, _mm256_set1_epi16(0x0120));
+  const __m256i quads = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00010400));
+  const __m256i merged = _mm256_or_si256(
+    _mm256_slli_epi64(quads, 20), _mm256_srli_epi64(quads, 32));
+  // 40 bits of each 64-bit lane in network order
+  const __m256i octets = _mm256_shuffle_epi8(merged, _mm256_setr_epi8(
+    4, 3, 2, 1, 0, 12, 11, 10, 9, 8, -1, -1, -1, -1, -1, -1,
+    4, 3, 2, 1, 0, 12, 11, 10, 9, 8, -1, -1, -1, -1, -1, -1));
+  _mm_storeu_si128((__m128i *)wire, _mm256_castsi256_si128(octets));
+  _mm_storeu_si128((__m128i *)(wire + 10), _mm256_extracti128_si256(octets, 1));
+  return true;
+}
+
+// base32hex without padding prefixed by its length, e.g. NSEC3 next hashed
+// owner name (RFC 5155 section 3.3)
+zone_nonnull_all()
+static zone_inline int32_t parse_base32(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  int32_t code;
+  uint8_t *octets = parser->rdata.octets + parser->rdata.length;
+  const char *data = token->data;
+  uint32_t bits = 0, accumulator = 0;
+  size_t length = 0;
+
+  if ((code = have_contiguous(parser, type, field, token)) < 0)
+    return code;
+
+  while (length + 20 <= 255 && decode_base32_block(data, octets + 1 + length)) {
+    data += 32;
+    length += 20;
+  }
+
+  for (uint8_t digit; (digit = base32_table[(uint8_t)*data]) != 0xff; data++) {
+    accumulator = (accumulator << 5) | digit;
+    bits += 5;
+    if (bits >= 8) {
+      bits -= 8;
+      if (length == 255)
+        return invalid_field(parser, type, field);
+      octets[++length] = (uint8_t)(accumulator >> bits);
+    }
+  }
+
+  // a partial quantum of five bits or more is not valid
+  if (!length || bits >= 5 || is_contiguous(data))
+    return invalid_field(parser, type, field);
+  octets[0] = (uint8_t)length;
+  parser->rdata.length += 1 + length;
+  return 0;
+}
+
+#endif // BASE32_H
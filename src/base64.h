@@ -0,0 +1,205 @@
+/*
+ * base64.h -- parse base64 fields
+ *
+ * Copyright (c) 2023, NLnet Labs. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#ifndef BASE64_H
+#define BASE64_H
+
+// base64 alphabet (RFC 4648 section 4), 0xff for padding and invalid
+static const uint8_t base64_table[256] = {
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3e, 0xff, 0xff, 0xff, 0x3f,
+  0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+  0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+  0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30, 0x31, 0x32, 0x33, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+
+#define BASE64_PADDED (4)
+
+// decode 32 base64 digits to 24 octets if all digits are valid. digits are
+// validated and translated with nibble lookups, then packed with
+// multiply-add (Muła and Lemire, "Faster Base64 Encoding and Decoding using
+// AVX2 Instructions"). 32 octets are written to the RDATA buffer, which is
+// padded
+zone_nonnull_all()
+static zone_inline bool decode_base64_block(const char *data, uint8_t *wire)
+{
+  const __m256i lut_lo = _mm256_setr_epi8(
+    0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+    0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a,
+    0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+    0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+  const __m256i lut_hi = _mm256_setr_epi8(
+    0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+  const __m256i lut_roll = _mm256_setr_epi8(
+    0,  16,  19,   4, -65, -65, -71, -71,
+    0,   0,   0,   0,   0,   0,   0,   0,
+    0,  16,  19,   4, -65, -65, -71, -71,
+    0,   0,   0,   0,   0,   0,   0,   0);
+  const __m256i mask_2f = _mm256_set1_epi8(0x2f);
+
+  __m256i input = _mm256_loadu_si256((const __m256i *)data);
+  const __m256i hi_nibbles = _mm256_and_si256(_mm256_srli_epi32(input, 4), mask_2f);
+  const __m256i lo_nibbles = _mm256_and_si256(input, mask_2f);
+  const __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+  const __m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+  if (!_mm256_testz_si256(lo, hi))
+    return false;
+
+  // "/" shares its high nibble with "+" but needs a different offset
+  const __m256i eq_2f = _mm256_cmpeq_epi8(input, mask_2f);
+  const __m256i roll = _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(eq_2f, hi_nibbles));
+  input = _mm256_add_epi8(input, roll);
+
+  // merge 6-bit digits into 24-bit groups and drop the unused octets
+  const __m256i pairs = _mm256_maddubs_epi16(input, _mm256_set1_epi32(0x01400140));
+  __m256i output = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+  output = _mm256_shuffle_epi8(output, _mm256_setr_epi8(
+     2,  1,  0,  6,  5,  4, 10,  9,  8, 14, 13, 12, -1, -1, -1, -1,
+     2,  1,  0,  6,  5,  4, 10,  9,  8, 14, 13, 12, -1, -1, -1, -1));
+  output = _mm256_permutevar8x32_epi32(output, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, -1, -1));
+  _mm256_storeu_si256((__m256i *)wire, output);
+  return true;
+}
+
+// decode the base64 digits in one token, state carries over to the next
+// token if whitespace is allowed
+zone_nonnull_all()
+static zone_inline int32_t scan_base64(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  const token_t *token,
+  uint8_t **octets,
+  uint32_t *state)
+{
+  const char *data = token->data;
+  uint8_t *wire = *octets;
+  const uint8_t *limit = parser->rdata.octets + 65535;
+
+  if (*state == BASE64_PADDED)
+    return invalid_field(parser, type, field);
+
+  // decode aligned blocks of 32 digits, the scalar loop takes over at the
+  // end of the token, at padding and to carry state across tokens
+  if (*state == 0) {
+    while (wire + 24 <= limit && decode_base64_block(data, wire)) {
+      data += 32;
+      wire += 24;
+    }
+  }
+
+  for (uint8_t digit; (digit = base64_table[(uint8_t)*data]) != 0xff; data++) {
+    switch (*state) {
+      case 0:
+        wire[0] = (uint8_t)(digit << 2);
+        *state = 1;
+        break;
+      case 1:
+        wire[0] |= (uint8_t)(digit >> 4);
+        wire[1] = (uint8_t)(digit << 4);
+        wire += 1;
+        *state = 2;
+        break;
+      case 2:
+        wire[0] |= (uint8_t)(digit >> 2);
+        wire[1] = (uint8_t)(digit << 6);
+        wire += 1;
+        *state = 3;
+        break;
+      default:
+        wire[0] |= digit;
+        wire += 1;
+        *state = 0;
+        break;
+    }
+    if (wire > limit)
+      return rdata_too_long(parser, type, field);
+  }
+
+  if (*data == '=') {
+    if (*state == 2 && data[1] == '=')
+      data += 2;
+    else if (*state == 3)
+      data += 1;
+    else
+      return invalid_field(parser, type, field);
+    *state = BASE64_PADDED;
+  }
+
+  if (is_contiguous(data))
+    return invalid_field(parser, type, field);
+  *octets = wire;
+  return 0;
+}
+
+// base64 that makes up the remainder of the RDATA, whitespace is allowed
+// (RFC 4034 section 2.2). consumes all tokens, token is the delimiter on
+// return
+zone_nonnull_all()
+static zone_inline int32_t parse_base64(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  int32_t code;
+  uint32_t state = 0;
+  uint8_t *wire = parser->rdata.octets + parser->rdata.length;
+
+  if ((code = have_contiguous(parser, type, field, token)) < 0)
+    return code;
+
+  do {
+    if ((code = scan_base64(parser, type, field, token, &wire, &state)) < 0)
+      return code;
+    lex(parser, token);
+  } while (token->code == CONTIGUOUS);
+
+  if (state != 0 && state != BASE64_PADDED)
+    return invalid_field(parser, type, field);
+  parser->rdata.length = (size_t)(wire - parser->rdata.octets);
+  return 0;
+}
+
+// base64 in a single token, e.g. the public key in HIP (RFC 8005 section 4)
+zone_nonnull_all()
+static zone_inline int32_t parse_base64_token(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  int32_t code;
+  uint32_t state = 0;
+  uint8_t *wire = parser->rdata.octets + parser->rdata.length;
+
+  if ((code = have_contiguous(parser, type, field, token)) < 0)
+    return code;
+  if ((code = scan_base64(parser, type, field, token, &wire, &state)) < 0)
+    return code;
+  if (state != 0 && state != BASE64_PADDED)
+    return invalid_field(parser, type, field);
+  parser->rdata.length = (size_t)(wire - parser->rdata.octets);
+  return 0;
+}
+
+#endif // BASE64_H
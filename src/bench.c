@@ -6,50 +6,777 @@
  * SPDX-License-Identifier: BSD-3-Clause
  *
  */
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if _WIN32
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#endif
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 #include "zone.h"
 #include "diagnostic.h"
 #include "log.h"
+#include "heap.h"
 #include "simd.h"
 #include "bits.h"
+#include "accept.h"
 #include "lexer.h"
 #include "scanner.h"
+#include "fields.h"
+#include "number.h"
+#include "ttl.h"
+#include "timestamp.h"
+#include "ip4.h"
+#include "ip6.h"
+#include "name.h"
+#include "text.h"
+#include "base16.h"
+#include "base32.h"
+#include "base64.h"
+#include "eui.h"
+#include "loc.h"
+#include "apl.h"
+#include "mnemonic.h"
+#include "type.h"
+#include "nsec.h"
+#include "svcb.h"
+#include "types.h"
+#include "generic.h"
+#include "generate.h"
+#include "parser.h"
+
+// lex command measures the scanner only, other commands parse records
+static bool lex_only = false;
 
 diagnostic_push()
 clang_diagnostic_ignored(missing-prototypes)
 
-int32_t parse(zone_parser_t *parser, size_t *user_data)
+int32_t parse(zone_parser_t *parser, void *user_data)
 {
   token_t token;
-  int32_t result;
   size_t tokens = 0;
 
-  (void)user_data;
+  if (!lex_only)
+    return parse_records(parser);
 
-  while ((result = lex(parser, &token)) > 0) {
-  //  printf("token: (%d), starts with: %c\n", result, *token.data);
+  for (lex(parser, &token); token.code > 0; lex(parser, &token))
     tokens++;
+
+  *(size_t *)user_data = tokens;
+  return token.code;
+}
+
+diagnostic_pop()
+
+static uint64_t now(void)
+{
+  struct timespec ts;
+  (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000llu + (uint64_t)ts.tv_nsec;
+}
+
+// cache misses are counted with perf events on Linux, provided the kernel
+// exposes hardware counters. first level data cache (reads) and last level
+// cache misses are counted, for user space only
+#define COUNTERS (2)
+
+typedef struct counters counters_t;
+struct counters {
+  int fds[COUNTERS];
+};
+
+static void start_counters(counters_t *counters)
+{
+#if defined(__linux__)
+  static const struct { uint32_t type; uint64_t config; } events[COUNTERS] = {
+    { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                          (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES }
+  };
+
+  for (size_t i=0; i < COUNTERS; i++) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = events[i].type;
+    attr.config = events[i].config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    counters->fds[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (counters->fds[i] >= 0)
+      (void)ioctl(counters->fds[i], PERF_EVENT_IOC_ENABLE, 0);
   }
+#else
+  for (size_t i=0; i < COUNTERS; i++)
+    counters->fds[i] = -1;
+#endif
+}
+
+// returns false if counters are not available
+static bool stop_counters(counters_t *counters, uint64_t values[COUNTERS])
+{
+  bool available = true;
+
+  for (size_t i=0; i < COUNTERS; i++) {
+#if defined(__linux__)
+    if (counters->fds[i] < 0) {
+      available = false;
+      continue;
+    }
+    (void)ioctl(counters->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+    if (read(counters->fds[i], &values[i], sizeof(values[i])) != sizeof(values[i]))
+      available = false;
+    (void)close(counters->fds[i]);
+#else
+    (void)values;
+    available = false;
+#endif
+  }
+
+  return available;
+}
+
+static int32_t count_record(
+  zone_parser_t *parser,
+  const zone_name_t *owner,
+  uint16_t type,
+  uint16_t class,
+  uint32_t ttl,
+  uint16_t rdlength,
+  const uint8_t *rdata,
+  void *user_data)
+{
+  (void)parser;
+  (void)owner;
+  (void)type;
+  (void)class;
+  (void)ttl;
+  (void)rdlength;
+  (void)rdata;
+  (*(size_t *)user_data)++;
+  return 0;
+}
+
+static int32_t count_records(
+  zone_parser_t *parser,
+  const zone_record_t *records,
+  size_t count,
+  void *user_data)
+{
+  (void)parser;
+  (void)records;
+  *(size_t *)user_data += count;
+  return 0;
+}
+
+// stream contains wire-format records back-to-back
+static size_t count_stream(const zone_stream_t *stream)
+{
+  size_t count = 0;
+
+  for (size_t length = 0; length < stream->length; count++) {
+    while (stream->octets[length])
+      length += 1 + stream->octets[length];
+    length += 1 + RR_FIXED_SIZE;
+    length += (size_t)(stream->octets[length - 2] << 8) | stream->octets[length - 1];
+  }
+
+  return count;
+}
+
+static uint64_t file_size(const char *path)
+{
+  FILE *file;
+  long size;
+
+  if (!(file = fopen(path, "rb")))
+    return 0;
+  size = fseek(file, 0, SEEK_END) == 0 ? ftell(file) : 0;
+  (void)fclose(file);
+  return size < 0 ? 0 : (uint64_t)size;
+}
 
+static int32_t bench_lex(
+  const zone_options_t *options, zone_buffers_t *buffers, const char *path)
+{
+  int32_t result;
+  size_t tokens = 0;
+  zone_parser_t parser;
+
+  lex_only = true;
+  if ((result = zone_parse(&parser, options, buffers, path, &tokens)) < 0)
+    return result;
   printf("parsed %zu tokens\n", tokens);
+  return 0;
+}
 
+#define BATCH_SIZE (64)
+#define ARENA_SIZE (1024 * 1024)
+
+// measure end-to-end throughput for each mode of delivery, i.e. add (one
+// callback per record), batch (one callback per BATCH_SIZE records), arena
+// (batch with rdata packed in an arena) and stream (wire format, no
+// callbacks). buffer footprint and cache misses are reported as they differ
+// between modes, compare batch (rdata slots) and arena for the effect of
+// packing rdata
+static int32_t bench_parse(
+  zone_options_t *options, const char *mode, const char *path)
+{
+  int32_t result = ZONE_OUT_OF_MEMORY;
+  size_t records = 0, footprint;
+  uint64_t start, elapsed, misses[COUNTERS];
+  counters_t counters;
+  zone_parser_t parser;
+  zone_buffers_t buffers = { 1, NULL, NULL, { 0, NULL } };
+  zone_stream_t stream = { 0, 0, NULL };
+  size_t rdatas = 1;
+
+  if (strcmp(mode, "add") == 0) {
+    options->accept.add = count_record;
+  } else if (strcmp(mode, "batch") == 0) {
+    options->accept.batch = count_records;
+    buffers.size = rdatas = BATCH_SIZE;
+  } else if (strcmp(mode, "arena") == 0) {
+    options->accept.batch = count_records;
+    buffers.size = BATCH_SIZE;
+    buffers.arena.size = ARENA_SIZE;
+  } else if (strcmp(mode, "stream") == 0) {
+    options->accept.stream = &stream;
+  } else {
+    return ZONE_BAD_PARAMETER;
+  }
+
+  buffers.owner = malloc(buffers.size * sizeof(*buffers.owner));
+  buffers.rdata = malloc(rdatas * sizeof(*buffers.rdata));
+  if (buffers.arena.size)
+    buffers.arena.octets = malloc(buffers.arena.size);
+  if (!buffers.owner || !buffers.rdata || (buffers.arena.size && !buffers.arena.octets))
+    goto error;
+
+  start_counters(&counters);
+  start = now();
+  result = zone_parse(&parser, options, &buffers, path, &records);
+  elapsed = now() - start;
+  const bool have_misses = stop_counters(&counters, misses);
+  if (result < 0)
+    goto error;
+
+  footprint = buffers.size * sizeof(*buffers.owner) +
+              rdatas * sizeof(*buffers.rdata) + buffers.arena.size;
+  if (options->accept.stream) {
+    records = count_stream(&stream);
+    footprint += stream.size;
+  }
+
+  const double seconds = (double)elapsed / 1e9;
+  printf("parsed %zu records in %.3f s (%s)\n", records, seconds, mode);
+  printf("%.0f records/s, %.1f MB/s, %zu KB of buffers\n",
+    (double)records / seconds,
+    (double)file_size(path) / seconds / 1e6,
+    footprint / 1024);
+  if (have_misses)
+    printf("%.2f L1d read misses/record, %.2f LLC misses/record\n",
+      (double)misses[0] / (double)records,
+      (double)misses[1] / (double)records);
+  else
+    printf("cache misses not available\n");
+error:
+  free(stream.octets);
+  free(buffers.arena.octets);
+  free(buffers.rdata);
+  free(buffers.owner);
   return result;
 }
 
-diagnostic_pop()
+// measure fixed per-zone overhead by parsing the same (small) zone over and
+// over, once allocating all state for every parse, once reusing the parser
+static int32_t bench_overhead(
+  zone_options_t *options,
+  zone_buffers_t *buffers,
+  const char *path,
+  size_t count)
+{
+  int32_t result = 0;
+  uint64_t start, oneshot, reused;
+  size_t records = 0;
+  zone_parser_t *parser;
 
-int main(int argc, char *argv[])
+  if (!(parser = zone_parser_create()))
+    return ZONE_OUT_OF_MEMORY;
+
+  options->accept.add = count_record;
+
+  start = now();
+  for (size_t i=0; i < count && result >= 0; i++) {
+    zone_parser_t stack;
+    records = 0;
+    result = zone_parse(&stack, options, buffers, path, &records);
+  }
+  oneshot = now() - start;
+
+  start = now();
+  for (size_t i=0; i < count && result >= 0; i++) {
+    records = 0;
+    result = zone_parser_parse(parser, options, buffers, path, &records);
+  }
+  reused = now() - start;
+
+  zone_parser_destroy(parser);
+  if (result < 0)
+    return result;
+
+  printf("parsed %zu zones of %zu records\n", count, records);
+  printf("zone_parse:        %8.1f ns/zone\n", (double)oneshot / (double)count);
+  printf("zone_parser_parse: %8.1f ns/zone\n", (double)reused / (double)count);
+  return 0;
+}
+
+// strncasecmp table scan, the baseline for the perfect hash
+static const mnemonic_t *scan_mnemonics(const char *data, size_t length)
+{
+  for (size_t i=0; i < sizeof(mnemonics)/sizeof(mnemonics[0]); i++)
+    if (strlen(mnemonics[i].name) == length &&
+        strncasecmp(mnemonics[i].name, data, length) == 0)
+      return &mnemonics[i];
+  return NULL;
+}
+
+// measure type and class recognition as done for records, i.e. including
+// the length of the token. inputs mix case and include generic notation,
+// which misses in both and is parsed separately
+static int32_t bench_mnemonics(size_t count)
+{
+  static const char *inputs[] = {
+    "IN", "a", "AAAA", "ns", "CNAME", "Mx", "TXT", "SOA", "ds", "RRSIG",
+    "nsec", "DNSKEY", "nsec3", "NSEC3PARAM", "Caa", "https", "TYPE65534",
+    "CLASS3"
+  };
+  static char padded[sizeof(inputs)/sizeof(inputs[0])][16 + ZONE_PADDING_SIZE];
+  static zone_parser_t parser;
+  const size_t n = sizeof(inputs)/sizeof(inputs[0]);
+  uint64_t start, hashed, scanned;
+  size_t found = 0;
+
+  if (!check_mnemonics())
+    return ZONE_SYNTAX_ERROR;
+  for (size_t i=0; i < n; i++) {
+    memcpy(padded[i], inputs[i], strlen(inputs[i]));
+    padded[i][strlen(inputs[i])] = ' ';
+  }
+
+  start = now();
+  for (size_t i=0; i < count; i++) {
+    for (size_t j=0; j < n; j++) {
+      const token_t token = { CONTIGUOUS, padded[j] };
+      uint16_t code;
+      found += scan_type_or_class(&parser, &rr_type, &rr_fields[3], &token, &code) > 0;
+    }
+  }
+  hashed = now() - start;
+
+  start = now();
+  for (size_t i=0; i < count; i++) {
+    for (size_t j=0; j < n; j++) {
+      const token_t token = { CONTIGUOUS, padded[j] };
+      uint16_t code;
+      found += scan_mnemonics(padded[j], token_length(&token)) ||
+               scan_generic(padded[j], "TYPE", 4, &code) ||
+               scan_generic(padded[j], "CLASS", 5, &code);
+    }
+  }
+  scanned = now() - start;
+
+  printf("looked up %zu mnemonics (%zu found)\n", count * n, found);
+  printf("perfect hash: %8.2f ns/lookup\n", (double)hashed / (double)(count * n));
+  printf("strncasecmp:  %8.2f ns/lookup\n", (double)scanned / (double)(count * n));
+  return 0;
+}
+
+// measure TTL conversion in isolation, the baseline converts one digit at a
+// time like scan_number does
+static int32_t bench_ttls(size_t count)
+{
+  static const char *inputs[] = {
+    "0", "300", "3600", "86400", "604800", "2147483647", "1h", "1w2d3h4m5s"
+  };
+  static char padded[sizeof(inputs)/sizeof(inputs[0])][16 + ZONE_PADDING_SIZE];
+  static zone_parser_t parser;
+  const size_t n = sizeof(inputs)/sizeof(inputs[0]);
+  const size_t plain = 6;
+  uint64_t start, swar, scalar, friendly;
+  uint64_t total = 0;
+
+  parser.options.friendly_ttls = true;
+  for (size_t i=0; i < n; i++)
+    memcpy(padded[i], inputs[i], strlen(inputs[i]));
+
+  start = now();
+  for (size_t i=0; i < count; i++) {
+    for (size_t j=0; j < plain; j++) {
+      const token_t token = { CONTIGUOUS, padded[j] };
+      uint32_t seconds = 0;
+      if (scan_ttl(&parser, &rr_type, &rr_fields[1], &token, &seconds) < 0)
+        return ZONE_SYNTAX_ERROR;
+      total += seconds;
+    }
+  }
+  swar = now() - start;
+
+  start = now();
+  for (size_t i=0; i < count; i++) {
+    for (size_t j=0; j < plain; j++) {
+      uint64_t seconds;
+      const size_t length = scan_number(padded[j], &seconds);
+      if (!length || is_contiguous(padded[j] + length) || seconds > MAX_TTL)
+        return ZONE_SYNTAX_ERROR;
+      total += seconds;
+    }
+  }
+  scalar = now() - start;
+
+  start = now();
+  for (size_t i=0; i < count; i++) {
+    for (size_t j=plain; j < n; j++) {
+      const token_t token = { CONTIGUOUS, padded[j] };
+      uint32_t seconds = 0;
+      if (scan_ttl(&parser, &rr_type, &rr_fields[1], &token, &seconds) < 0)
+        return ZONE_SYNTAX_ERROR;
+      total += seconds;
+    }
+  }
+  friendly = now() - start;
+
+  printf("converted %zu TTLs (total %" PRIu64 ")\n", count * n, total);
+  printf("swar:     %8.2f ns/ttl\n", (double)swar / (double)(count * plain));
+  printf("scalar:   %8.2f ns/ttl\n", (double)scalar / (double)(count * plain));
+  printf("friendly: %8.2f ns/ttl\n", (double)friendly / (double)(count * (n - plain)));
+  return 0;
+}
+
+// measure IPv4 conversion in isolation against inet_pton
+static int32_t bench_ip4s(size_t count)
+{
+  static const char *inputs[] = {
+    "192.0.2.1", "10.0.0.1", "198.51.100.254", "203.0.113.17", "1.1.1.1",
+    "255.255.255.255", "172.16.254.3", "127.0.0.1"
+  };
+  static char padded[sizeof(inputs)/sizeof(inputs[0])][16 + ZONE_PADDING_SIZE];
+  const size_t n = sizeof(inputs)/sizeof(inputs[0]);
+  uint64_t start, simd, pton;
+  uint64_t total = 0;
+
+  for (size_t i=0; i < n; i++)
+    memcpy(padded[i], inputs[i], strlen(inputs[i]));
+
+  start = now();
+  for (size_t i=0; i < count; i++) {
+    for (size_t j=0; j < n; j++) {
+      uint8_t octets[4];
+      size_t length;
+      if (!scan_ip4(padded[j], octets, &length))
+        return ZONE_SYNTAX_ERROR;
+      total += octets[3];
+    }
+  }
+  simd = now() - start;
+
+  start = now();
+  for (size_t i=0; i < count; i++) {
+    for (size_t j=0; j < n; j++) {
+      uint8_t octets[4];
+      if (inet_pton(AF_INET, padded[j], octets) != 1)
+        return ZONE_SYNTAX_ERROR;
+      total += octets[3];
+    }
+  }
+  pton = now() - start;
+
+  printf("converted %zu addresses (total %" PRIu64 ")\n", 2 * count * n, total);
+  printf("simd:      %8.2f ns/address\n", (double)simd / (double)(count * n));
+  printf("inet_pton: %8.2f ns/address\n", (double)pton / (double)(count * n));
+  return 0;
+}
+
+// measure IPv6 conversion in isolation against inet_pton, the mix contains
+// compressed, uncompressed and IPv4-mapped addresses
+static int32_t bench_ip6s(size_t count)
+{
+  static const char *inputs[] = {
+    "2001:db8::1", "2001:db8:85a3::8a2e:370:7334", "fe80::1ff:fe23:4567:890a",
+    "::1", "2606:4700:4700::1111", "2001:0db8:0000:0000:0000:ff00:0042:8329",
+    "::ffff:192.0.2.128", "64:ff9b::198.51.100.1"
+  };
+  static char padded[sizeof(inputs)/sizeof(inputs[0])][64 + ZONE_PADDING_SIZE];
+  const size_t n = sizeof(inputs)/sizeof(inputs[0]);
+  uint64_t start, simd, pton;
+  uint64_t total = 0;
+
+  for (size_t i=0; i < n; i++)
+    memcpy(padded[i], inputs[i], strlen(inputs[i]));
+
+  start = now();
+  for (size_t i=0; i < count; i++) {
+    for (size_t j=0; j < n; j++) {
+      uint8_t octets[16];
+      size_t length;
+      if (!scan_ip6(padded[j], octets, &length))
+        return ZONE_SYNTAX_ERROR;
+      total += octets[15];
+    }
+  }
+  simd = now() - start;
+
+  start = now();
+  for (size_t i=0; i < count; i++) {
+    for (size_t j=0; j < n; j++) {
+      uint8_t octets[16];
+      if (inet_pton(AF_INET6, padded[j], octets) != 1)
+        return ZONE_SYNTAX_ERROR;
+      total += octets[15];
+    }
+  }
+  pton = now() - start;
+
+  printf("converted %zu addresses (total %" PRIu64 ")\n", 2 * count * n, total);
+  printf("simd:      %8.2f ns/address\n", (double)simd / (double)(count * n));
+  printf("inet_pton: %8.2f ns/address\n", (double)pton / (double)(count * n));
+  return 0;
+}
+
+static int32_t bench_names(size_t count)
+{
+  static const char *inputs[][2] = {
+    { "www.example.com.", "www\\.example.com." },
+    { "host-1.", "host\\0451." },
+    { "mail.example.org.", "mail\\032server.example.org." },
+    { "_sip._tcp.example.net.", "\\_sip.\\_tcp.example.net." },
+    { "a.b.c.d.e.f.g.h.", "a.b\\.c.d.e\\.f.g.h." },
+    { "xn--bcher-kva.example.", "b\\195\\188cher.example." },
+    { "relative", "rel\\097tive" },
+    { "ns1.long-domain-name-for-benchmarking.example.com.",
+      "ns1.long\\-domain\\-name\\-for\\-benchmarking.example.com." }
+  };
+  static char padded[sizeof(inputs)/sizeof(inputs[0])][2][64 + ZONE_PADDING_SIZE];
+  static zone_parser_t parser;
+  static zone_file_t file;
+  const size_t n = sizeof(inputs)/sizeof(inputs[0]);
+  uint64_t start, times[2];
+  uint64_t total = 0;
+
+  memcpy(file.origin.octets, "\7example\3com", 13);
+  file.origin.length = 13;
+  parser.file = &file;
+  for (size_t i=0; i < n; i++)
+    for (size_t j=0; j < 2; j++)
+      memcpy(padded[i][j], inputs[i][j], strlen(inputs[i][j]));
+
+  for (size_t j=0; j < 2; j++) {
+    start = now();
+    for (size_t i=0; i < count; i++) {
+      for (size_t k=0; k < n; k++) {
+        const token_t token = { CONTIGUOUS, padded[k][j] };
+        uint8_t octets[255 + ZONE_BLOCK_SIZE];
+        size_t length;
+        if (scan_name(&parser, &rr_type, &rr_fields[0], &token, octets, &length) < 0)
+          return ZONE_SYNTAX_ERROR;
+        total += length;
+      }
+    }
+    times[j] = now() - start;
+  }
+
+  printf("converted %zu names (total %" PRIu64 ")\n", 2 * count * n, total);
+  printf("plain:   %8.2f ns/name\n", (double)times[0] / (double)(count * n));
+  printf("escaped: %8.2f ns/name\n", (double)times[1] / (double)(count * n));
+  return 0;
+}
+
+typedef struct image_check image_check_t;
+struct image_check {
+  const zone_image_t *image;
+  size_t records;
+  uint64_t elapsed;
+};
+
+// every record parsed from the zone must be found in the image, i.e. an
+// RRset with the same owner, type and class must contain the RDATA
+static int32_t check_record(
+  zone_parser_t *parser,
+  const zone_name_t *owner,
+  uint16_t type,
+  uint16_t class,
+  uint32_t ttl,
+  uint16_t rdlength,
+  const uint8_t *rdata,
+  void *user_data)
+{
+  image_check_t *check = user_data;
+  zone_rrset_t rrset;
+  int32_t count;
+  const uint64_t start = now();
+
+  (void)parser;
+  (void)ttl;
+  count = zone_image_lookup(check->image, owner->octets, owner->length, type, &rrset);
+  check->elapsed += now() - start;
+  if (count < 0)
+    return count;
+  if (!count || rrset.class != class)
+    return ZONE_BAD_IMAGE;
+
+  const uint8_t *octets = rrset.rdata;
+  for (int32_t i=0; i < count; i++) {
+    uint16_t length;
+    memcpy(&length, octets, sizeof(length));
+    if (length == rdlength && memcmp(octets + sizeof(length), rdata, length) == 0) {
+      check->records++;
+      return 0;
+    }
+    octets += sizeof(length) + length;
+  }
+
+  return ZONE_BAD_IMAGE;
+}
+
+// write an image of the zone, map it and look up every record of the zone
+// in the image. verifies the writer and reader agree and measures lookups
+static int32_t bench_image(
+  zone_options_t *options,
+  zone_buffers_t *buffers,
+  const char *zone,
+  const char *path)
 {
-  if (argc != 2)
-    return 1;
+  int32_t result;
   zone_parser_t parser;
+  zone_image_writer_t *writer;
+  image_check_t check = { NULL, 0, 0 };
+  zone_image_t *image = NULL;
+  uint64_t start, written;
+
+  if (!(writer = zone_image_writer_create()))
+    return ZONE_OUT_OF_MEMORY;
+
+  start = now();
+  options->accept.add = zone_image_add;
+  if ((result = zone_parse(&parser, options, buffers, zone, writer)) < 0 ||
+      (result = zone_image_write(writer, path)) < 0)
+    goto error;
+  written = now() - start;
+
+  if ((result = zone_image_open(&image, path)) < 0)
+    goto error;
+  check.image = image;
+  options->accept.add = check_record;
+  if ((result = zone_parse(&parser, options, buffers, zone, &check)) < 0) {
+    if (result == ZONE_BAD_IMAGE)
+      fprintf(stderr, "record not found in image\n");
+    goto error;
+  }
+
+  printf("wrote image of %" PRIu64 " octets in %.3f s\n",
+    file_size(path), (double)written / 1e9);
+  printf("verified %zu records, %.1f ns/lookup\n",
+    check.records, (double)check.elapsed / (double)check.records);
+error:
+  zone_image_close(image);
+  zone_image_writer_destroy(writer);
+  return result;
+}
+
+static void usage(const char *program)
+{
+  fprintf(stderr, "usage: %s lex <zone-file>\n", program);
+  fprintf(stderr, "       %s parse [add|batch|arena|stream] <zone-file>\n", program);
+  fprintf(stderr, "       %s overhead [count] <zone-file>\n", program);
+  fprintf(stderr, "       %s mnemonics [count]\n", program);
+  fprintf(stderr, "       %s ttls [count]\n", program);
+  fprintf(stderr, "       %s ip4s [count]\n", program);
+  fprintf(stderr, "       %s ip6s [count]\n", program);
+  fprintf(stderr, "       %s names [count]\n", program);
+  fprintf(stderr, "       %s image <zone-file> <image-file>\n", program);
+}
+
+int main(int argc, char *argv[])
+{
+  int32_t result;
   zone_options_t options = { 0 };
   zone_name_buffer_t names[1];
   zone_rdata_buffer_t rdatas[1];
-  zone_buffers_t buffers = { 1, names, rdatas };
+  zone_buffers_t buffers = { 1, names, rdatas, { 0, NULL } };
 
   options.origin = "example.com.";
+  options.default_ttl = 3600;
 
-  int32_t result = zone_parse(&parser, &options, &buffers, argv[1], NULL);
+  if (argc == 3 && strcmp(argv[1], "lex") == 0) {
+    options.accept.add = count_record;
+    result = bench_lex(&options, &buffers, argv[2]);
+  } else if (argc >= 3 && argc <= 4 && strcmp(argv[1], "parse") == 0) {
+    const char *mode = argc == 4 ? argv[2] : "add";
+    result = bench_parse(&options, mode, argv[argc - 1]);
+    if (result == ZONE_BAD_PARAMETER) {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  } else if (argc >= 3 && argc <= 4 && strcmp(argv[1], "overhead") == 0) {
+    size_t count = argc == 4 ? strtoul(argv[2], NULL, 10) : 100000;
+    if (!count) {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+    result = bench_overhead(&options, &buffers, argv[argc - 1], count);
+  } else if (argc >= 2 && argc <= 3 && strcmp(argv[1], "mnemonics") == 0) {
+    size_t count = argc == 3 ? strtoul(argv[2], NULL, 10) : 1000000;
+    if (!count) {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+    result = bench_mnemonics(count);
+  } else if (argc >= 2 && argc <= 3 && strcmp(argv[1], "ttls") == 0) {
+    size_t count = argc == 3 ? strtoul(argv[2], NULL, 10) : 1000000;
+    if (!count) {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+    result = bench_ttls(count);
+  } else if (argc >= 2 && argc <= 3 && strcmp(argv[1], "ip4s") == 0) {
+    size_t count = argc == 3 ? strtoul(argv[2], NULL, 10) : 1000000;
+    if (!count) {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+    result = bench_ip4s(count);
+  } else if (argc >= 2 && argc <= 3 && strcmp(argv[1], "ip6s") == 0) {
+    size_t count = argc == 3 ? strtoul(argv[2], NULL, 10) : 1000000;
+    if (!count) {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+    result = bench_ip6s(count);
+  } else if (argc >= 2 && argc <= 3 && strcmp(argv[1], "names") == 0) {
+    size_t count = argc == 3 ? strtoul(argv[2], NULL, 10) : 1000000;
+    if (!count) {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+    result = bench_names(count);
+  } else if (argc == 4 && strcmp(argv[1], "image") == 0) {
+    result = bench_image(&options, &buffers, argv[2], argv[3]);
+  } else {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
 
-  return result;
+  return result < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
 }
@@ -0,0 +1,100 @@
+/*
+ * eui.h -- parse EUI-48, EUI-64 and ILNP identifiers
+ *
+ * Copyright (c) 2023, NLnet Labs. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#ifndef EUI_H
+#define EUI_H
+
+// pairs of hexadecimal digits separated by hyphens, e.g. 00-00-5e-00-53-2a
+// (RFC 7043 section 3.2)
+zone_nonnull_all()
+static zone_inline int32_t scan_eui(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  const token_t *token,
+  size_t count)
+{
+  int32_t code;
+  const char *data = token->data;
+  uint8_t *octets = parser->rdata.octets + parser->rdata.length;
+
+  if ((code = have_contiguous(parser, type, field, token)) < 0)
+    return code;
+
+  for (size_t i=0; i < count; i++, data += 2) {
+    if (i && *data++ != '-')
+      return invalid_field(parser, type, field);
+    const uint8_t d0 = base16_table[(uint8_t)data[0]];
+    const uint8_t d1 = base16_table[(uint8_t)data[1]];
+    if (d0 == 0xff || d1 == 0xff)
+      return invalid_field(parser, type, field);
+    octets[i] = (uint8_t)((d0 << 4) | d1);
+  }
+
+  if (is_contiguous(data))
+    return invalid_field(parser, type, field);
+  parser->rdata.length += count;
+  return 0;
+}
+
+zone_nonnull_all()
+static zone_inline int32_t parse_eui48(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  return scan_eui(parser, type, field, token, 6);
+}
+
+zone_nonnull_all()
+static zone_inline int32_t parse_eui64(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  return scan_eui(parser, type, field, token, 8);
+}
+
+// four groups of one to four hexadecimal digits separated by colons, like
+// the upper half of an IPv6 address (RFC 6742 section 2.3)
+zone_nonnull_all()
+static zone_inline int32_t parse_ilnp64(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  int32_t code;
+  const char *data = token->data;
+  uint8_t *octets = parser->rdata.octets + parser->rdata.length;
+
+  if ((code = have_contiguous(parser, type, field, token)) < 0)
+    return code;
+
+  for (size_t i=0; i < 4; i++) {
+    uint16_t group = 0;
+    size_t length = 0;
+    for (uint8_t digit; (digit = base16_table[(uint8_t)*data]) != 0xff; data++) {
+      if (++length > 4)
+        return invalid_field(parser, type, field);
+      group = (uint16_t)((group << 4) | digit);
+    }
+    if (!length || (i < 3 && *data++ != ':'))
+      return invalid_field(parser, type, field);
+    write_int16(octets + 2*i, group);
+  }
+
+  if (is_contiguous(data))
+    return invalid_field(parser, type, field);
+  parser->rdata.length += 8;
+  return 0;
+}
+
+#endif // EUI_H
@@ -0,0 +1,157 @@
+/*
+ * fields.h -- type and field descriptors shared by RDATA parsers
+ *
+ * Copyright (c) 2023, NLnet Labs. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#ifndef FIELDS_H
+#define FIELDS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "zone.h"
+#include "log.h"
+#include "lexer.h"
+
+// wire format of fields, the presentation format is implied by the parse
+// function of the type
+#define FIELD_INT8 (1)
+#define FIELD_INT16 (2)
+#define FIELD_INT32 (3)
+#define FIELD_IP4 (4)
+#define FIELD_IP6 (5)
+#define FIELD_NAME (6)
+#define FIELD_STRING (7) // length prefixed (character-string, salt, hash)
+#define FIELD_STRINGS (8) // sequence of length prefixed strings
+#define FIELD_BLOB (9) // remainder of RDATA
+#define FIELD_TYPES (10) // type bitmap (RFC 4034 section 4.1.2)
+#define FIELD_ILNP64 (11) // node identifier or locator (RFC 6742 section 2.3)
+#define FIELD_EUI48 (12) // 48-bit extended unique identifier (RFC 7043)
+#define FIELD_EUI64 (13) // 64-bit extended unique identifier (RFC 7043)
+#define FIELD_SVC_PARAMS (14) // service parameters (RFC 9460 section 2.2)
+
+// field may be omitted if it is the last field
+#define OPTIONAL (1u<<0)
+// name is converted to lower case in canonical form (RFC 4034 section 6.2)
+#define CANONICAL (1u<<1)
+
+typedef struct symbol symbol_t;
+struct symbol {
+  zone_string_t name;
+  uint32_t value;
+};
+
+typedef struct field_info field_info_t;
+struct field_info {
+  zone_string_t name;
+  uint32_t type;
+  uint32_t qualifiers;
+  struct {
+    size_t length;
+    const symbol_t *symbols;
+  } symbols; /**< Mnemonics accepted in place of a number */
+};
+
+typedef struct type_info type_info_t;
+
+typedef int32_t(*rdata_parse_t)(
+  zone_parser_t *, const type_info_t *, token_t *);
+
+struct type_info {
+  zone_string_t name;
+  uint16_t code;
+  /** Maximum length of RDATA in wire format. */
+  size_t bound;
+  struct {
+    size_t length;
+    const field_info_t *fields;
+  } rdata;
+  rdata_parse_t parse;
+};
+
+#define NAME(info) (int)(info)->name.length, (info)->name.data
+
+#define SYMBOL(name, value) { { sizeof(name) - 1, name }, value }
+
+#define FIELD(name, type) \
+  { { sizeof(name) - 1, name }, type, 0, { 0, NULL } }
+
+#define OPTIONAL_FIELD(name, type) \
+  { { sizeof(name) - 1, name }, type, OPTIONAL, { 0, NULL } }
+
+#define CANONICAL_FIELD(name, type) \
+  { { sizeof(name) - 1, name }, type, CANONICAL, { 0, NULL } }
+
+#define SYMBOLIC_FIELD(name, type, symbols) \
+  { { sizeof(name) - 1, name }, type, 0, \
+    { sizeof(symbols) / sizeof(symbols[0]), symbols } }
+
+// errors are reported once, subsequent checks only propagate the code
+zone_nonnull_all()
+static zone_no_inline int32_t unexpected_token(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  const token_t *token)
+{
+  if (token->code < 0)
+    return token->code;
+  if (token->code == CONTIGUOUS || token->code == QUOTED)
+    SYNTAX_ERROR(parser, "Invalid %.*s in %.*s", NAME(field), NAME(type));
+  SYNTAX_ERROR(parser, "Missing %.*s in %.*s", NAME(field), NAME(type));
+}
+
+zone_nonnull_all()
+static zone_inline int32_t have_contiguous(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  const token_t *token)
+{
+  if (zone_unlikely(token->code != CONTIGUOUS))
+    return unexpected_token(parser, type, field, token);
+  return 0;
+}
+
+zone_nonnull_all()
+static zone_inline int32_t have_string(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  const token_t *token)
+{
+  if (zone_unlikely(!(token->code & STRING)))
+    return unexpected_token(parser, type, field, token);
+  return 0;
+}
+
+zone_nonnull_all()
+static zone_no_inline int32_t trailing_data(
+  zone_parser_t *parser, const type_info_t *type, const token_t *token)
+{
+  if (token->code < 0)
+    return token->code;
+  SYNTAX_ERROR(parser, "Trailing data in %.*s", NAME(type));
+}
+
+zone_nonnull_all()
+static zone_inline int32_t have_delimiter(
+  zone_parser_t *parser, const type_info_t *type, const token_t *token)
+{
+  if (zone_unlikely(token->code > LINE_FEED || token->code < 0))
+    return trailing_data(parser, type, token);
+  return 0;
+}
+
+zone_nonnull_all()
+static zone_no_inline int32_t rdata_too_long(
+  zone_parser_t *parser, const type_info_t *type, const field_info_t *field)
+{
+  SYNTAX_ERROR(parser, "Invalid %.*s in %.*s, RDATA exceeds maximum length",
+               NAME(field), NAME(type));
+}
+
+#endif // FIELDS_H
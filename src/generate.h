@@ -0,0 +1,219 @@
+/*
+ * generate.h -- expand $GENERATE templates
+ *
+ * Copyright (c) 2023, NLnet Labs. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#ifndef GENERATE_H
+#define GENERATE_H
+
+// names in presentation format take at most 4 characters per octet
+#define GENERATE_MAX_LENGTH (4 * 255)
+#define GENERATE_MAX_COUNTERS (8)
+
+// substitution of the iterator, i.e. ${offset,width,base} (BIND 9). digits
+// are kept in the expanded text and are incremented in place
+typedef struct generate_counter generate_counter_t;
+struct generate_counter {
+  size_t position; // of first digit in text
+  size_t length;
+  uint32_t base;
+  const char *digits;
+};
+
+// template is expanded once, every iteration merely increments counters.
+// text is terminated and padded so that it can be passed to scanners
+typedef struct generate_template generate_template_t;
+struct generate_template {
+  int32_t code; // CONTIGUOUS or QUOTED
+  size_t length;
+  size_t count;
+  generate_counter_t counters[GENERATE_MAX_COUNTERS];
+  char text[GENERATE_MAX_LENGTH + 1 + ZONE_PADDING_SIZE];
+};
+
+static const char generate_lower[] = "0123456789abcdef";
+static const char generate_upper[] = "0123456789ABCDEF";
+
+zone_nonnull_all()
+static zone_inline uint32_t generate_digit(char digit)
+{
+  if ((uint8_t)(digit - '0') <= 9)
+    return (uint32_t)(digit - '0');
+  return (uint32_t)((digit | 0x20) - 'a') + 10;
+}
+
+// insert most significant digit, moves all text and counters that follow
+zone_nonnull_all()
+static zone_no_inline bool insert_digit(
+  generate_template_t *template, size_t index, char digit)
+{
+  generate_counter_t *counter = &template->counters[index];
+  char *text = template->text + counter->position;
+
+  if (template->length == GENERATE_MAX_LENGTH)
+    return false;
+  memmove(text + 1, text, template->length - counter->position + 1);
+  text[0] = digit;
+  template->length++;
+  counter->length++;
+  for (size_t i = index + 1; i < template->count; i++)
+    template->counters[i].position++;
+  return true;
+}
+
+// add to the counter in its own base, digits are only inserted if the
+// number of digits grows, i.e. once every power of the base
+zone_nonnull_all()
+static zone_inline bool increment_counter(
+  generate_template_t *template, size_t index, uint64_t step)
+{
+  generate_counter_t *counter = &template->counters[index];
+  char *text = template->text + counter->position;
+  uint64_t carry = step;
+
+  for (size_t i = counter->length; carry && i--; ) {
+    const uint64_t value = generate_digit(text[i]) + carry;
+    text[i] = counter->digits[value % counter->base];
+    carry = value / counter->base;
+  }
+
+  for (; carry; carry /= counter->base)
+    if (!insert_digit(template, index, counter->digits[carry % counter->base]))
+      return false;
+  return true;
+}
+
+zone_nonnull_all()
+static zone_inline bool increment_template(
+  generate_template_t *template, uint64_t step)
+{
+  for (size_t i = 0; i < template->count; i++)
+    if (!increment_counter(template, i, step))
+      return false;
+  return true;
+}
+
+// format the initial value, zero padded to width
+zone_nonnull_all()
+static zone_inline bool format_counter(
+  generate_template_t *template, generate_counter_t *counter, uint64_t value, uint64_t width)
+{
+  char digits[64];
+  size_t length = 0;
+
+  do {
+    digits[length++] = counter->digits[value % counter->base];
+    value /= counter->base;
+  } while (value);
+  while (length < width && length < sizeof(digits))
+    digits[length++] = '0';
+
+  if (template->length + length > GENERATE_MAX_LENGTH)
+    return false;
+  counter->position = template->length;
+  counter->length = length;
+  for (size_t i = 0; i < length; i++)
+    template->text[template->length++] = digits[length - 1 - i];
+  return true;
+}
+
+// $ or ${offset[,width[,base]]}, base is one of d, o, x or X. returns the
+// number of characters consumed or 0 on error
+zone_nonnull_all()
+static zone_inline size_t scan_counter(
+  const char *data, const char *end, int64_t *offset, uint64_t *width, generate_counter_t *counter)
+{
+  const char *start = data;
+  uint64_t number;
+  size_t count;
+  bool negative;
+
+  *offset = 0;
+  *width = 0;
+  counter->base = 10;
+  counter->digits = generate_lower;
+
+  assert(*data == '$');
+  if (++data == end || *data != '{')
+    return 1;
+
+  data++;
+  if ((negative = *data == '-') || *data == '+')
+    data++;
+  if (!(count = scan_number(data, &number)) || number > UINT32_MAX)
+    return 0;
+  *offset = negative ? -(int64_t)number : (int64_t)number;
+  data += count;
+
+  if (data < end && *data == ',') {
+    data++;
+    if (!(count = scan_number(data, &number)) || number > 63)
+      return 0;
+    *width = number;
+    data += count;
+
+    if (data < end && *data == ',') {
+      switch (*++data) {
+        case 'd': break;
+        case 'o': counter->base = 8; break;
+        case 'x': counter->base = 16; break;
+        case 'X': counter->base = 16; counter->digits = generate_upper; break;
+        default: return 0;
+      }
+      data++;
+    }
+  }
+
+  if (data >= end || *data != '}')
+    return 0;
+  return (size_t)(++data - start);
+}
+
+// expand the template for the first iteration. escape sequences are copied
+// verbatim and decoded by the scanner, hence "\$" denotes a literal "$"
+zone_nonnull_all()
+static zone_inline bool compile_template(
+  generate_template_t *template, const token_t *token, uint64_t start)
+{
+  const char *data = token->data;
+  const char *end = data + token_length(token);
+
+  template->code = token->code;
+  template->length = 0;
+  template->count = 0;
+  memset(template->text, 0, sizeof(template->text));
+
+  while (data < end) {
+    if (*data == '$') {
+      generate_counter_t *counter = &template->counters[template->count];
+      int64_t offset;
+      uint64_t width;
+      size_t count;
+      if (template->count == GENERATE_MAX_COUNTERS)
+        return false;
+      if (!(count = scan_counter(data, end, &offset, &width, counter)))
+        return false;
+      if ((int64_t)start + offset < 0)
+        return false;
+      if (!format_counter(template, counter, (uint64_t)((int64_t)start + offset), width))
+        return false;
+      template->count++;
+      data += count;
+    } else {
+      const size_t count = (*data == '\\' && data + 1 < end) ? 2 : 1;
+      if (template->length + count > GENERATE_MAX_LENGTH)
+        return false;
+      memcpy(template->text + template->length, data, count);
+      template->length += count;
+      data += count;
+    }
+  }
+
+  template->text[template->length] = '\0';
+  return true;
+}
+
+#endif // GENERATE_H
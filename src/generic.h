@@ -0,0 +1,172 @@
+/*
+ * generic.h -- parse RDATA in generic notation
+ *
+ * Copyright (c) 2023, NLnet Labs. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#ifndef GENERIC_H
+#define GENERIC_H
+
+static const field_info_t generic_fields[] = {
+  FIELD("rdlength", FIELD_INT16),
+  FIELD("rdata", FIELD_BLOB)
+};
+
+zone_nonnull_all()
+static zone_no_inline int32_t length_mismatch(
+  zone_parser_t *parser, const type_info_t *type, const field_info_t *field)
+{
+  SYNTAX_ERROR(parser, "Invalid %.*s in %.*s, length does not match",
+               NAME(field), NAME(type));
+}
+
+// decode exactly length octets of hexadecimal digits, whitespace is allowed.
+// the declared length bounds the output, surplus digits are detected as soon
+// as they are decoded. consumes all tokens, token is the delimiter on return
+zone_nonnull_all()
+static zone_inline int32_t parse_generic_base16(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token,
+  size_t length)
+{
+  int32_t code;
+  uint32_t state = 0;
+  uint8_t *wire = parser->rdata.octets + parser->rdata.length;
+  const uint8_t *limit = wire + length;
+
+  if ((code = have_contiguous(parser, type, field, token)) < 0)
+    return code;
+
+  do {
+    const char *data = token->data;
+    if (state == 0) {
+      while (wire + 16 <= limit && decode_base16_block(data, wire)) {
+        data += 32;
+        wire += 16;
+      }
+    }
+
+    for (uint8_t digit; (digit = base16_table[(uint8_t)*data]) != 0xff; data++) {
+      if (wire == limit)
+        return length_mismatch(parser, type, field);
+      if (state)
+        *wire++ |= digit;
+      else
+        *wire = (uint8_t)(digit << 4);
+      state ^= 1;
+    }
+    if (is_contiguous(data))
+      return invalid_field(parser, type, field);
+    lex(parser, token);
+  } while (token->code == CONTIGUOUS);
+
+  if (state || wire != limit)
+    return length_mismatch(parser, type, field);
+  parser->rdata.length = (size_t)(wire - parser->rdata.octets);
+  return 0;
+}
+
+// RDATA in generic notation must be valid for the type if the type is known
+// (RFC 3597 section 5). fields are checked for framing only, i.e. fixed
+// sizes, length octets and uncompressed names
+zone_nonnull_all()
+static zone_inline int32_t check_generic_rdata(
+  zone_parser_t *parser, const type_info_t *type)
+{
+  const uint8_t *octets = parser->rdata.octets;
+  const uint8_t *end = octets + parser->rdata.length;
+
+  for (size_t i=0; i < type->rdata.length; i++) {
+    const field_info_t *field = &type->rdata.fields[i];
+    size_t length = 0;
+
+    if (octets == end && (field->qualifiers & OPTIONAL))
+      break;
+
+    switch (field->type) {
+      case FIELD_INT8:
+        length = 1;
+        break;
+      case FIELD_INT16:
+        length = 2;
+        break;
+      case FIELD_INT32:
+      case FIELD_IP4:
+        length = 4;
+        break;
+      case FIELD_EUI48:
+        length = 6;
+        break;
+      case FIELD_ILNP64:
+      case FIELD_EUI64:
+        length = 8;
+        break;
+      case FIELD_IP6:
+        length = 16;
+        break;
+      case FIELD_NAME: {
+        uint8_t label;
+        do {
+          if (octets + length >= end || (octets[length] & 0xc0))
+            return invalid_field(parser, type, field);
+          label = octets[length];
+          length += 1 + label;
+        } while (label && length <= 255);
+        if (length > 255)
+          return invalid_field(parser, type, field);
+      } break;
+      case FIELD_STRING:
+        if (octets == end)
+          return invalid_field(parser, type, field);
+        length = 1 + octets[0];
+        break;
+      case FIELD_STRINGS:
+        if (octets == end)
+          return invalid_field(parser, type, field);
+        while (octets + length < end)
+          length += 1 + octets[length];
+        break;
+      default:
+        length = (size_t)(end - octets);
+        break;
+    }
+
+    if (length > (size_t)(end - octets))
+      return invalid_field(parser, type, field);
+    octets += length;
+  }
+
+  if (octets != end)
+    SYNTAX_ERROR(parser, "Trailing data in %.*s", NAME(type));
+  return 0;
+}
+
+// \# <length> <hexadecimal data> (RFC 3597 section 5), token is \#. the
+// RDATA is checked against the descriptor of the type unless the parser
+// operates as a secondary, in which case the data was checked upstream
+zone_nonnull_all()
+static zone_no_inline int32_t parse_generic_rdata(
+  zone_parser_t *parser, const type_info_t *type, token_t *token)
+{
+  int32_t code;
+  uint64_t length;
+
+  lex(parser, token);
+  if ((code = scan_int(parser, type, &generic_fields[0], token, UINT16_MAX, &length)) < 0)
+    return code;
+  lex(parser, token);
+  if (length && (code = parse_generic_base16(parser, type, &generic_fields[1], token, (size_t)length)) < 0)
+    return code;
+  if ((code = have_delimiter(parser, type, token)) < 0)
+    return code;
+  if (!parser->options.secondary && type->rdata.length &&
+      (code = check_generic_rdata(parser, type)) < 0)
+    return code;
+  return accept_rr(parser, parser->user_data);
+}
+
+#endif // GENERIC_H
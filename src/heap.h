@@ -0,0 +1,48 @@
+/*
+ * heap.h -- memory allocation through user supplied allocator
+ *
+ * Copyright (c) 2023, NLnet Labs. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#ifndef HEAP_H
+#define HEAP_H
+
+#include <stdlib.h>
+
+#include "zone.h"
+
+// allocator callbacks are either all set or all unset (see check_options)
+zone_nonnull_all()
+static inline void *zone_malloc(zone_parser_t *parser, size_t size)
+{
+  const zone_allocator_t *allocator = &parser->options.allocator;
+  if (!allocator->malloc)
+    return malloc(size);
+  return allocator->malloc(allocator->arena, size);
+}
+
+zone_nonnull((1))
+static inline void *zone_realloc(
+  zone_parser_t *parser, void *pointer, size_t size)
+{
+  const zone_allocator_t *allocator = &parser->options.allocator;
+  if (!allocator->realloc)
+    return realloc(pointer, size);
+  return allocator->realloc(allocator->arena, pointer, size);
+}
+
+zone_nonnull((1))
+static inline void zone_free(zone_parser_t *parser, void *pointer)
+{
+  const zone_allocator_t *allocator = &parser->options.allocator;
+  if (!pointer)
+    return;
+  if (!allocator->free)
+    free(pointer);
+  else
+    allocator->free(allocator->arena, pointer);
+}
+
+#endif // HEAP_H
@@ -0,0 +1,577 @@
+/*
+ * image.c -- memory mappable zone images
+ *
+ * Copyright (c) 2023, NLnet Labs. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#if !_WIN32
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+#include "zone.h"
+
+// image layout (all integers in host order, sections aligned to 8 octets)
+//
+//   header
+//   names   : name_count x image_name_t, sorted canonically
+//   rrsets  : rrset_count x image_rrset_t, grouped by name, sorted by type
+//   data    : owner names (wire format) and RDATA of each RRset, each
+//             record prefixed by its length (2 octets)
+#define IMAGE_MAGIC "ZONEIMG"
+#define IMAGE_VERSION (1u)
+#define IMAGE_BYTE_ORDER (0x01020304u)
+
+typedef struct image_header image_header_t;
+struct image_header {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t size;
+  uint64_t name_count;
+  uint64_t rrset_count;
+  uint64_t names;
+  uint64_t rrsets;
+  uint64_t data;
+};
+
+typedef struct image_name image_name_t;
+struct image_name {
+  uint64_t octets; // offset in data
+  uint32_t length;
+  uint32_t rrsets; // index of first RRset
+  uint32_t count; // number of RRsets
+  uint32_t padding;
+};
+
+typedef struct image_rrset image_rrset_t;
+struct image_rrset {
+  uint16_t type;
+  uint16_t class;
+  uint32_t ttl;
+  uint32_t count; // number of records
+  uint32_t padding;
+  uint64_t rdata; // offset in data
+};
+
+typedef struct record record_t;
+struct record {
+  union { size_t offset; const uint8_t *octets; } owner, rdata;
+  uint8_t owner_length;
+  uint16_t rdlength;
+  uint16_t type;
+  uint16_t class;
+  uint32_t ttl;
+};
+
+struct zone_image_writer {
+  struct {
+    size_t size, length;
+    uint8_t *octets;
+  } data;
+  struct {
+    size_t size, length;
+    record_t *records;
+  } records;
+};
+
+struct zone_image {
+  size_t size;
+  const uint8_t *octets;
+  const image_header_t *header;
+  const image_name_t *names;
+  const image_rrset_t *rrsets;
+  const uint8_t *data;
+};
+
+static const uint8_t lower[256] = {
+  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+  0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+  0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+  0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f,
+  0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27,
+  0x28, 0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f,
+  0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37,
+  0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0x3e, 0x3f,
+  0x40, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, // "@abcdefg"
+  0x68, 0x69, 0x6a, 0x6b, 0x6c, 0x6d, 0x6e, 0x6f, // "hijklmno"
+  0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, // "pqrstuvw"
+  0x78, 0x79, 0x7a, 0x5b, 0x5c, 0x5d, 0x5e, 0x5f, // "xyz"
+  0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67,
+  0x68, 0x69, 0x6a, 0x6b, 0x6c, 0x6d, 0x6e, 0x6f,
+  0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77,
+  0x78, 0x79, 0x7a, 0x7b, 0x7c, 0x7d, 0x7e, 0x7f,
+  0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+  0x88, 0x89, 0x8a, 0x8b, 0x8c, 0x8d, 0x8e, 0x8f,
+  0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97,
+  0x98, 0x99, 0x9a, 0x9b, 0x9c, 0x9d, 0x9e, 0x9f,
+  0xa0, 0xa1, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+  0xa8, 0xa9, 0xaa, 0xab, 0xac, 0xad, 0xae, 0xaf,
+  0xb0, 0xb1, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7,
+  0xb8, 0xb9, 0xba, 0xbb, 0xbc, 0xbd, 0xbe, 0xbf,
+  0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7,
+  0xc8, 0xc9, 0xca, 0xcb, 0xcc, 0xcd, 0xce, 0xcf,
+  0xd0, 0xd1, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7,
+  0xd8, 0xd9, 0xda, 0xdb, 0xdc, 0xdd, 0xde, 0xdf,
+  0xe0, 0xe1, 0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7,
+  0xe8, 0xe9, 0xea, 0xeb, 0xec, 0xed, 0xee, 0xef,
+  0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7,
+  0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff,
+};
+
+// names in images and names passed by the caller are untrusted. a valid
+// name is at most 255 octets, consists of labels of at most 63 octets and
+// ends with the root label exactly at the end
+static bool check_name(const uint8_t *octets, size_t length)
+{
+  size_t offset = 0;
+
+  if (!length || length > 255)
+    return false;
+  while (offset < length && octets[offset]) {
+    if (octets[offset] > 63)
+      return false;
+    offset += 1 + octets[offset];
+  }
+
+  return offset == length - 1;
+}
+
+// collect offsets of labels, returns number of labels (excluding root).
+// names must be checked, a name of 255 octets has at most 127 labels
+static size_t split_labels(
+  const uint8_t *octets, size_t length, uint8_t labels[128])
+{
+  size_t count = 0;
+
+  for (size_t offset = 0; offset < length && octets[offset] && count < 128; ) {
+    labels[count++] = (uint8_t)offset;
+    offset += 1 + octets[offset];
+  }
+
+  return count;
+}
+
+// canonical ordering of names as specified in RFC4034 section 6.1
+static int compare_names(
+  const uint8_t *octets1, size_t length1,
+  const uint8_t *octets2, size_t length2)
+{
+  uint8_t labels1[128], labels2[128];
+  size_t count1 = split_labels(octets1, length1, labels1);
+  size_t count2 = split_labels(octets2, length2, labels2);
+
+  while (count1 && count2) {
+    const uint8_t *label1 = octets1 + labels1[--count1];
+    const uint8_t *label2 = octets2 + labels2[--count2];
+    const size_t length = label1[0] < label2[0] ? label1[0] : label2[0];
+    for (size_t i=1; i <= length; i++) {
+      if (lower[label1[i]] != lower[label2[i]])
+        return lower[label1[i]] < lower[label2[i]] ? -1 : 1;
+    }
+    if (label1[0] != label2[0])
+      return label1[0] < label2[0] ? -1 : 1;
+  }
+
+  return count1 == count2 ? 0 : (count1 < count2 ? -1 : 1);
+}
+
+static int compare_rdata(const record_t *record1, const record_t *record2)
+{
+  const size_t length = record1->rdlength < record2->rdlength
+    ? record1->rdlength : record2->rdlength;
+  int result;
+  if ((result = memcmp(record1->rdata.octets, record2->rdata.octets, length)))
+    return result;
+  if (record1->rdlength != record2->rdlength)
+    return record1->rdlength < record2->rdlength ? -1 : 1;
+  return 0;
+}
+
+static int compare_records(const void *pointer1, const void *pointer2)
+{
+  const record_t *record1 = pointer1, *record2 = pointer2;
+  int result;
+
+  if ((result = compare_names(
+         record1->owner.octets, record1->owner_length,
+         record2->owner.octets, record2->owner_length)))
+    return result;
+  if (record1->type != record2->type)
+    return record1->type < record2->type ? -1 : 1;
+  if (record1->class != record2->class)
+    return record1->class < record2->class ? -1 : 1;
+  return compare_rdata(record1, record2);
+}
+
+zone_image_writer_t *zone_image_writer_create(void)
+{
+  zone_image_writer_t *writer;
+
+  if (!(writer = calloc(1, sizeof(*writer))))
+    return NULL;
+  return writer;
+}
+
+void zone_image_writer_destroy(zone_image_writer_t *writer)
+{
+  if (!writer)
+    return;
+  free(writer->data.octets);
+  free(writer->records.records);
+  free(writer);
+}
+
+int32_t zone_image_add(
+  zone_parser_t *parser,
+  const zone_name_t *owner,
+  uint16_t type,
+  uint16_t class,
+  uint32_t ttl,
+  uint16_t rdlength,
+  const uint8_t *rdata,
+  void *user_data)
+{
+  zone_image_writer_t *writer = user_data;
+  const size_t length = owner->length + (size_t)rdlength;
+
+  (void)parser;
+
+  if (writer->data.size - writer->data.length < length) {
+    size_t size = writer->data.size ? writer->data.size * 2 : 65536;
+    while (size - writer->data.length < length)
+      size *= 2;
+    uint8_t *octets = realloc(writer->data.octets, size);
+    if (!octets)
+      return ZONE_OUT_OF_MEMORY;
+    writer->data.size = size;
+    writer->data.octets = octets;
+  }
+
+  if (writer->records.length == writer->records.size) {
+    size_t size = writer->records.size ? writer->records.size * 2 : 1024;
+    record_t *records = realloc(writer->records.records, size * sizeof(*records));
+    if (!records)
+      return ZONE_OUT_OF_MEMORY;
+    writer->records.size = size;
+    writer->records.records = records;
+  }
+
+  // offsets are converted to pointers once all records have been added
+  record_t *record = &writer->records.records[writer->records.length++];
+  record->owner.offset = writer->data.length;
+  record->owner_length = owner->length;
+  memcpy(writer->data.octets + writer->data.length, owner->octets, owner->length);
+  writer->data.length += owner->length;
+  record->rdata.offset = writer->data.length;
+  record->rdlength = rdlength;
+  memcpy(writer->data.octets + writer->data.length, rdata, rdlength);
+  writer->data.length += rdlength;
+  record->type = type;
+  record->class = class;
+  record->ttl = ttl;
+  return 0;
+}
+
+static int32_t write_image(
+  const zone_image_writer_t *writer,
+  FILE *handle,
+  image_name_t *names,
+  image_rrset_t *rrsets)
+{
+  const record_t *records = writer->records.records;
+  const size_t count = writer->records.length;
+  image_header_t header;
+  uint64_t data = 0;
+  size_t name_count = 0, rrset_count = 0;
+
+  // index names and rrsets, skipping duplicate records
+  for (size_t i=0; i < count; i++) {
+    const record_t *record = &records[i];
+    if (i && compare_records(&records[i-1], record) == 0)
+      continue;
+    if (!i || compare_names(records[i-1].owner.octets, records[i-1].owner_length,
+                            record->owner.octets, record->owner_length) != 0) {
+      image_name_t *name = &names[name_count++];
+      name->octets = data;
+      name->length = record->owner_length;
+      name->rrsets = (uint32_t)rrset_count;
+      name->count = 0;
+      name->padding = 0;
+      data += record->owner_length;
+    } else if (records[i-1].type == record->type &&
+               records[i-1].class == record->class) {
+      image_rrset_t *rrset = &rrsets[rrset_count - 1];
+      rrset->count++;
+      if (record->ttl < rrset->ttl)
+        rrset->ttl = record->ttl;
+      data += 2 + record->rdlength;
+      continue;
+    }
+
+    image_rrset_t *rrset = &rrsets[rrset_count++];
+    rrset->type = record->type;
+    rrset->class = record->class;
+    rrset->ttl = record->ttl;
+    rrset->count = 1;
+    rrset->padding = 0;
+    rrset->rdata = data;
+    names[name_count - 1].count++;
+    data += 2 + record->rdlength;
+  }
+
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC));
+  header.version = IMAGE_VERSION;
+  header.byte_order = IMAGE_BYTE_ORDER;
+  header.name_count = name_count;
+  header.rrset_count = rrset_count;
+  header.names = sizeof(header); // 64 octets
+  header.rrsets = header.names + name_count * sizeof(*names);
+  header.data = header.rrsets + rrset_count * sizeof(*rrsets);
+  header.size = header.data + data;
+
+  if (fwrite(&header, sizeof(header), 1, handle) != 1 ||
+      fwrite(names, sizeof(*names), name_count, handle) != name_count ||
+      fwrite(rrsets, sizeof(*rrsets), rrset_count, handle) != rrset_count)
+    return ZONE_IO_ERROR;
+
+  for (size_t i=0; i < count; i++) {
+    const record_t *record = &records[i];
+    if (i && compare_records(&records[i-1], record) == 0)
+      continue;
+    if (!i || compare_names(records[i-1].owner.octets, records[i-1].owner_length,
+                            record->owner.octets, record->owner_length) != 0) {
+      if (fwrite(record->owner.octets, record->owner_length, 1, handle) != 1)
+        return ZONE_IO_ERROR;
+    }
+    if (fwrite(&record->rdlength, sizeof(record->rdlength), 1, handle) != 1)
+      return ZONE_IO_ERROR;
+    if (record->rdlength &&
+        fwrite(record->rdata.octets, record->rdlength, 1, handle) != 1)
+      return ZONE_IO_ERROR;
+  }
+
+  return 0;
+}
+
+int32_t zone_image_write(zone_image_writer_t *writer, const char *path)
+{
+  int32_t result = ZONE_OUT_OF_MEMORY;
+  const size_t count = writer->records.length;
+  image_name_t *names = NULL;
+  image_rrset_t *rrsets = NULL;
+  FILE *handle = NULL;
+
+  if (count > UINT32_MAX)
+    return ZONE_BAD_PARAMETER;
+
+  for (size_t i=0; i < count; i++) {
+    record_t *record = &writer->records.records[i];
+    record->owner.octets = writer->data.octets + record->owner.offset;
+    record->rdata.octets = writer->data.octets + record->rdata.offset;
+  }
+
+  qsort(writer->records.records, count, sizeof(record_t), compare_records);
+
+  if (count && !(names = malloc(count * sizeof(*names))))
+    goto exit;
+  if (count && !(rrsets = malloc(count * sizeof(*rrsets))))
+    goto exit;
+
+  if (!(handle = fopen(path, "wb"))) {
+    result = errno == ENOMEM ? ZONE_OUT_OF_MEMORY : ZONE_IO_ERROR;
+    goto exit;
+  }
+
+  result = write_image(writer, handle, names, rrsets);
+  if (fclose(handle) != 0 && result == 0)
+    result = ZONE_IO_ERROR;
+
+exit:
+  // restore offsets so that more records can be added
+  for (size_t i=0; i < count; i++) {
+    record_t *record = &writer->records.records[i];
+    record->owner.offset = (size_t)(record->owner.octets - writer->data.octets);
+    record->rdata.offset = (size_t)(record->rdata.octets - writer->data.octets);
+  }
+  free(names);
+  free(rrsets);
+  return result;
+}
+
+static int32_t check_image(zone_image_t *image)
+{
+  const image_header_t *header = image->header;
+
+  if (image->size < sizeof(*header))
+    return ZONE_BAD_IMAGE;
+  if (memcmp(header->magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) != 0)
+    return ZONE_BAD_IMAGE;
+  if (header->version != IMAGE_VERSION)
+    return ZONE_BAD_IMAGE;
+  if (header->byte_order != IMAGE_BYTE_ORDER)
+    return ZONE_BAD_IMAGE;
+  if (header->size != image->size)
+    return ZONE_BAD_IMAGE;
+  // offsets are untrusted, each section is verified to lie within the image
+  // before it is used to compute the next, sums can therefore not overflow
+  if (header->names < sizeof(*header) || header->names > header->size ||
+      (header->names & 7))
+    return ZONE_BAD_IMAGE;
+  if (header->name_count > (header->size - header->names) / sizeof(image_name_t))
+    return ZONE_BAD_IMAGE;
+  if (header->rrsets != header->names + header->name_count * sizeof(image_name_t))
+    return ZONE_BAD_IMAGE;
+  if (header->rrset_count > (header->size - header->rrsets) / sizeof(image_rrset_t))
+    return ZONE_BAD_IMAGE;
+  if (header->data != header->rrsets + header->rrset_count * sizeof(image_rrset_t))
+    return ZONE_BAD_IMAGE;
+
+  image->names = (const image_name_t *)(image->octets + header->names);
+  image->rrsets = (const image_rrset_t *)(image->octets + header->rrsets);
+  image->data = image->octets + header->data;
+
+  // names are compared on lookup, verify each name once up front
+  const uint64_t size = header->size - header->data;
+  for (uint64_t i=0; i < header->name_count; i++) {
+    const image_name_t *name = &image->names[i];
+    if (name->octets > size || name->length > size - name->octets)
+      return ZONE_BAD_IMAGE;
+    if (!check_name(image->data + name->octets, name->length))
+      return ZONE_BAD_IMAGE;
+    if (name->rrsets > header->rrset_count ||
+        name->count > header->rrset_count - name->rrsets)
+      return ZONE_BAD_IMAGE;
+  }
+
+  return 0;
+}
+
+int32_t zone_image_open(zone_image_t **imageptr, const char *path)
+{
+#if _WIN32
+  (void)imageptr;
+  (void)path;
+  return ZONE_NOT_IMPLEMENTED;
+#else
+  int fd;
+  int32_t result;
+  struct stat st;
+  void *octets;
+  zone_image_t *image;
+
+  if ((fd = open(path, O_RDONLY)) == -1)
+    return errno == ENOENT ? ZONE_NOT_A_FILE : ZONE_IO_ERROR;
+  if (fstat(fd, &st) == -1 || !S_ISREG(st.st_mode)) {
+    (void)close(fd);
+    return ZONE_IO_ERROR;
+  }
+  if ((size_t)st.st_size < sizeof(image_header_t)) {
+    (void)close(fd);
+    return ZONE_BAD_IMAGE;
+  }
+
+  octets = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  (void)close(fd);
+  if (octets == MAP_FAILED)
+    return errno == ENOMEM ? ZONE_OUT_OF_MEMORY : ZONE_IO_ERROR;
+
+  if (!(image = malloc(sizeof(*image)))) {
+    (void)munmap(octets, (size_t)st.st_size);
+    return ZONE_OUT_OF_MEMORY;
+  }
+
+  image->size = (size_t)st.st_size;
+  image->octets = octets;
+  image->header = octets;
+  if ((result = check_image(image)) < 0) {
+    zone_image_close(image);
+    return result;
+  }
+
+  *imageptr = image;
+  return 0;
+#endif
+}
+
+void zone_image_close(zone_image_t *image)
+{
+  if (!image)
+    return;
+#if !_WIN32
+  (void)munmap((void *)image->octets, image->size);
+#endif
+  free(image);
+}
+
+int32_t zone_image_lookup(
+  const zone_image_t *image,
+  const uint8_t *owner,
+  size_t length,
+  uint16_t type,
+  zone_rrset_t *rrset)
+{
+  const image_header_t *header = image->header;
+  const size_t size = header->size - header->data;
+  const image_name_t *name = NULL;
+  size_t lower_bound = 0, upper_bound = header->name_count;
+
+  if (!check_name(owner, length))
+    return ZONE_BAD_PARAMETER;
+
+  // names and name to RRset mapping are verified by check_image
+  while (lower_bound < upper_bound) {
+    const size_t middle = lower_bound + (upper_bound - lower_bound) / 2;
+    const image_name_t *candidate = &image->names[middle];
+    const int result = compare_names(
+      owner, length, image->data + candidate->octets, candidate->length);
+    if (result == 0) {
+      name = candidate;
+      break;
+    } else if (result < 0) {
+      upper_bound = middle;
+    } else {
+      lower_bound = middle + 1;
+    }
+  }
+
+  if (!name)
+    return 0;
+
+  for (size_t i=0; i < name->count; i++) {
+    const image_rrset_t *candidate = &image->rrsets[name->rrsets + i];
+    if (candidate->type < type)
+      continue;
+    if (candidate->type > type)
+      break;
+    // verify records are contained in the image before handing out RDATA
+    uint64_t offset = candidate->rdata;
+    for (size_t j=0; j < candidate->count; j++) {
+      uint16_t rdlength;
+      if (offset > size || size - offset < sizeof(rdlength))
+        return ZONE_BAD_IMAGE;
+      memcpy(&rdlength, image->data + offset, sizeof(rdlength));
+      offset += sizeof(rdlength) + rdlength;
+    }
+    if (offset > size)
+      return ZONE_BAD_IMAGE;
+    rrset->owner_length = name->length;
+    rrset->owner = image->data + name->octets;
+    rrset->type = candidate->type;
+    rrset->class = candidate->class;
+    rrset->ttl = candidate->ttl;
+    rrset->count = candidate->count;
+    rrset->rdata = image->data + candidate->rdata;
+    return (int32_t)candidate->count;
+  }
+
+  return 0;
+}
@@ -0,0 +1,172 @@
+/*
+ * ip4.h -- parse IPv4 addresses
+ *
+ * Copyright (c) 2023, NLnet Labs. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#ifndef IP4_H
+#define IP4_H
+
+// shuffle masks indexed by the number of digits in each octet. the digits
+// of each octet are placed in its own 32-bit lane in hundreds, tens, ones
+// order, missing digits are zeroed
+static const uint8_t ip4_patterns[81][16] = {
+  { 0x80, 0x80, 0x00, 0x80, 0x80, 0x80, 0x02, 0x80, 0x80, 0x80, 0x04, 0x80, 0x80, 0x80, 0x06, 0x80 }, // 1.1.1.1
+  { 0x80, 0x80, 0x00, 0x80, 0x80, 0x80, 0x02, 0x80, 0x80, 0x80, 0x04, 0x80, 0x80, 0x06, 0x07, 0x80 }, // 1.1.1.2
+  { 0x80, 0x80, 0x00, 0x80, 0x80, 0x80, 0x02, 0x80, 0x80, 0x80, 0x04, 0x80, 0x06, 0x07, 0x08, 0x80 }, // 1.1.1.3
+  { 0x80, 0x80, 0x00, 0x80, 0x80, 0x80, 0x02, 0x80, 0x80, 0x04, 0x05, 0x80, 0x80, 0x80, 0x07, 0x80 }, // 1.1.2.1
+  { 0x80, 0x80, 0x00, 0x80, 0x80, 0x80, 0x02, 0x80, 0x80, 0x04, 0x05, 0x80, 0x80, 0x07, 0x08, 0x80 }, // 1.1.2.2
+  { 0x80, 0x80, 0x00, 0x80, 0x80, 0x80, 0x02, 0x80, 0x80, 0x04, 0x05, 0x80, 0x07, 0x08, 0x09, 0x80 }, // 1.1.2.3
+  { 0x80, 0x80, 0x00, 0x80, 0x80, 0x80, 0x02, 0x80, 0x04, 0x05, 0x06, 0x80, 0x80, 0x80, 0x08, 0x80 }, // 1.1.3.1
+  { 0x80, 0x80, 0x00, 0x80, 0x80, 0x80, 0x02, 0x80, 0x04, 0x05, 0x06, 0x80, 0x80, 0x08, 0x09, 0x80 }, // 1.1.3.2
+  { 0x80, 0x80, 0x00, 0x80, 0x80, 0x80, 0x02, 0x80, 0x04, 0x05, 0x06, 0x80, 0x08, 0x09, 0x0a, 0x80 }, // 1.1.3.3
+  { 0x80, 0x80, 0x00, 0x80, 0x80, 0x02, 0x03, 0x80, 0x80, 0x80, 0x05, 0x80, 0x80, 0x80, 0x07, 0x80 }, // 1.2.1.1
+  { 0x80, 0x80, 0x00, 0x80, 0x80, 0x02, 0x03, 0x80, 0x80, 0x80, 0x05, 0x80, 0x80, 0x07, 0x08, 0x80 }, // 1.2.1.2
+  { 0x80, 0x80, 0x00, 0x80, 0x80, 0x02, 0x03, 0x80, 0x80, 0x80, 0x05, 0x80, 0x07, 0x08, 0x09, 0x80 }, // 1.2.1.3
+  { 0x80, 0x80, 0x00, 0x80, 0x80, 0x02, 0x03, 0x80, 0x80, 0x05, 0x06, 0x80, 0x80, 0x80, 0x08, 0x80 }, // 1.2.2.1
+  { 0x80, 0x80, 0x00, 0x80, 0x80, 0x02, 0x03, 0x80, 0x80, 0x05, 0x06, 0x80, 0x80, 0x08, 0x09, 0x80 }, // 1.2.2.2
+  { 0x80, 0x80, 0x00, 0x80, 0x80, 0x02, 0x03, 0x80, 0x80, 0x05, 0x06, 0x80, 0x08, 0x09, 0x0a, 0x80 }, // 1.2.2.3
+  { 0x80, 0x80, 0x00, 0x80, 0x80, 0x02, 0x03, 0x80, 0x05, 0x06, 0x07, 0x80, 0x80, 0x80, 0x09, 0x80 }, // 1.2.3.1
+  { 0x80, 0x80, 0x00, 0x80, 0x80, 0x02, 0x03, 0x80, 0x05, 0x06, 0x07, 0x80, 0x80, 0x09, 0x0a, 0x80 }, // 1.2.3.2
+  { 0x80, 0x80, 0x00, 0x80, 0x80, 0x02, 0x03, 0x80, 0x05, 0x06, 0x07, 0x80, 0x09, 0x0a, 0x0b, 0x80 }, // 1.2.3.3
+  { 0x80, 0x80, 0x00, 0x80, 0x02, 0x03, 0x04, 0x80, 0x80, 0x80, 0x06, 0x80, 0x80, 0x80, 0x08, 0x80 }, // 1.3.1.1
+  { 0x80, 0x80, 0x00, 0x80, 0x02, 0x03, 0x04, 0x80, 0x80, 0x80, 0x06, 0x80, 0x80, 0x08, 0x09, 0x80 }, // 1.3.1.2
+  { 0x80, 0x80, 0x00, 0x80, 0x02, 0x03, 0x04, 0x80, 0x80, 0x80, 0x06, 0x80, 0x08, 0x09, 0x0a, 0x80 }, // 1.3.1.3
+  { 0x80, 0x80, 0x00, 0x80, 0x02, 0x03, 0x04, 0x80, 0x80, 0x06, 0x07, 0x80, 0x80, 0x80, 0x09, 0x80 }, // 1.3.2.1
+  { 0x80, 0x80, 0x00, 0x80, 0x02, 0x03, 0x04, 0x80, 0x80, 0x06, 0x07, 0x80, 0x80, 0x09, 0x0a, 0x80 }, // 1.3.2.2
+  { 0x80, 0x80, 0x00, 0x80, 0x02, 0x03, 0x04, 0x80, 0x80, 0x06, 0x07, 0x80, 0x09, 0x0a, 0x0b, 0x80 }, // 1.3.2.3
+  { 0x80, 0x80, 0x00, 0x80, 0x02, 0x03, 0x04, 0x80, 0x06, 0x07, 0x08, 0x80, 0x80, 0x80, 0x0a, 0x80 }, // 1.3.3.1
+  { 0x80, 0x80, 0x00, 0x80, 0x02, 0x03, 0x04, 0x80, 0x06, 0x07, 0x08, 0x80, 0x80, 0x0a, 0x0b, 0x80 }, // 1.3.3.2
+  { 0x80, 0x80, 0x00, 0x80, 0x02, 0x03, 0x04, 0x80, 0x06, 0x07, 0x08, 0x80, 0x0a, 0x0b, 0x0c, 0x80 }, // 1.3.3.3
+  { 0x80, 0x00, 0x01, 0x80, 0x80, 0x80, 0x03, 0x80, 0x80, 0x80, 0x05, 0x80, 0x80, 0x80, 0x07, 0x80 }, // 2.1.1.1
+  { 0x80, 0x00, 0x01, 0x80, 0x80, 0x80, 0x03, 0x80, 0x80, 0x80, 0x05, 0x80, 0x80, 0x07, 0x08, 0x80 }, // 2.1.1.2
+  { 0x80, 0x00, 0x01, 0x80, 0x80, 0x80, 0x03, 0x80, 0x80, 0x80, 0x05, 0x80, 0x07, 0x08, 0x09, 0x80 }, // 2.1.1.3
+  { 0x80, 0x00, 0x01, 0x80, 0x80, 0x80, 0x03, 0x80, 0x80, 0x05, 0x06, 0x80, 0x80, 0x80, 0x08, 0x80 }, // 2.1.2.1
+  { 0x80, 0x00, 0x01, 0x80, 0x80, 0x80, 0x03, 0x80, 0x80, 0x05, 0x06, 0x80, 0x80, 0x08, 0x09, 0x80 }, // 2.1.2.2
+  { 0x80, 0x00, 0x01, 0x80, 0x80, 0x80, 0x03, 0x80, 0x80, 0x05, 0x06, 0x80, 0x08, 0x09, 0x0a, 0x80 }, // 2.1.2.3
+  { 0x80, 0x00, 0x01, 0x80, 0x80, 0x80, 0x03, 0x80, 0x05, 0x06, 0x07, 0x80, 0x80, 0x80, 0x09, 0x80 }, // 2.1.3.1
+  { 0x80, 0x00, 0x01, 0x80, 0x80, 0x80, 0x03, 0x80, 0x05, 0x06, 0x07, 0x80, 0x80, 0x09, 0x0a, 0x80 }, // 2.1.3.2
+  { 0x80, 0x00, 0x01, 0x80, 0x80, 0x80, 0x03, 0x80, 0x05, 0x06, 0x07, 0x80, 0x09, 0x0a, 0x0b, 0x80 }, // 2.1.3.3
+  { 0x80, 0x00, 0x01, 0x80, 0x80, 0x03, 0x04, 0x80, 0x80, 0x80, 0x06, 0x80, 0x80, 0x80, 0x08, 0x80 }, // 2.2.1.1
+  { 0x80, 0x00, 0x01, 0x80, 0x80, 0x03, 0x04, 0x80, 0x80, 0x80, 0x06, 0x80, 0x80, 0x08, 0x09, 0x80 }, // 2.2.1.2
+  { 0x80, 0x00, 0x01, 0x80, 0x80, 0x03, 0x04, 0x80, 0x80, 0x80, 0x06, 0x80, 0x08, 0x09, 0x0a, 0x80 }, // 2.2.1.3
+  { 0x80, 0x00, 0x01, 0x80, 0x80, 0x03, 0x04, 0x80, 0x80, 0x06, 0x07, 0x80, 0x80, 0x80, 0x09, 0x80 }, // 2.2.2.1
+  { 0x80, 0x00, 0x01, 0x80, 0x80, 0x03, 0x04, 0x80, 0x80, 0x06, 0x07, 0x80, 0x80, 0x09, 0x0a, 0x80 }, // 2.2.2.2
+  { 0x80, 0x00, 0x01, 0x80, 0x80, 0x03, 0x04, 0x80, 0x80, 0x06, 0x07, 0x80, 0x09, 0x0a, 0x0b, 0x80 }, // 2.2.2.3
+  { 0x80, 0x00, 0x01, 0x80, 0x80, 0x03, 0x04, 0x80, 0x06, 0x07, 0x08, 0x80, 0x80, 0x80, 0x0a, 0x80 }, // 2.2.3.1
+  { 0x80, 0x00, 0x01, 0x80, 0x80, 0x03, 0x04, 0x80, 0x06, 0x07, 0x08, 0x80, 0x80, 0x0a, 0x0b, 0x80 }, // 2.2.3.2
+  { 0x80, 0x00, 0x01, 0x80, 0x80, 0x03, 0x04, 0x80, 0x06, 0x07, 0x08, 0x80, 0x0a, 0x0b, 0x0c, 0x80 }, // 2.2.3.3
+  { 0x80, 0x00, 0x01, 0x80, 0x03, 0x04, 0x05, 0x80, 0x80, 0x80, 0x07, 0x80, 0x80, 0x80, 0x09, 0x80 }, // 2.3.1.1
+  { 0x80, 0x00, 0x01, 0x80, 0x03, 0x04, 0x05, 0x80, 0x80, 0x80, 0x07, 0x80, 0x80, 0x09, 0x0a, 0x80 }, // 2.3.1.2
+  { 0x80, 0x00, 0x01, 0x80, 0x03, 0x04, 0x05, 0x80, 0x80, 0x80, 0x07, 0x80, 0x09, 0x0a, 0x0b, 0x80 }, // 2.3.1.3
+  { 0x80, 0x00, 0x01, 0x80, 0x03, 0x04, 0x05, 0x80, 0x80, 0x07, 0x08, 0x80, 0x80, 0x80, 0x0a, 0x80 }, // 2.3.2.1
+  { 0x80, 0x00, 0x01, 0x80, 0x03, 0x04, 0x05, 0x80, 0x80, 0x07, 0x08, 0x80, 0x80, 0x0a, 0x0b, 0x80 }, // 2.3.2.2
+  { 0x80, 0x00, 0x01, 0x80, 0x03, 0x04, 0x05, 0x80, 0x80, 0x07, 0x08, 0x80, 0x0a, 0x0b, 0x0c, 0x80 }, // 2.3.2.3
+  { 0x80, 0x00, 0x01, 0x80, 0x03, 0x04, 0x05, 0x80, 0x07, 0x08, 0x09, 0x80, 0x80, 0x80, 0x0b, 0x80 }, // 2.3.3.1
+  { 0x80, 0x00, 0x01, 0x80, 0x03, 0x04, 0x05, 0x80, 0x07, 0x08, 0x09, 0x80, 0x80, 0x0b, 0x0c, 0x80 }, // 2.3.3.2
+  { 0x80, 0x00, 0x01, 0x80, 0x03, 0x04, 0x05, 0x80, 0x07, 0x08, 0x09, 0x80, 0x0b, 0x0c, 0x0d, 0x80 }, // 2.3.3.3
+  { 0x00, 0x01, 0x02, 0x80, 0x80, 0x80, 0x04, 0x80, 0x80, 0x80, 0x06, 0x80, 0x80, 0x80, 0x08, 0x80 }, // 3.1.1.1
+  { 0x00, 0x01, 0x02, 0x80, 0x80, 0x80, 0x04, 0x80, 0x80, 0x80, 0x06, 0x80, 0x80, 0x08, 0x09, 0x80 }, // 3.1.1.2
+  { 0x00, 0x01, 0x02, 0x80, 0x80, 0x80, 0x04, 0x80, 0x80, 0x80, 0x06, 0x80, 0x08, 0x09, 0x0a, 0x80 }, // 3.1.1.3
+  { 0x00, 0x01, 0x02, 0x80, 0x80, 0x80, 0x04, 0x80, 0x80, 0x06, 0x07, 0x80, 0x80, 0x80, 0x09, 0x80 }, // 3.1.2.1
+  { 0x00, 0x01, 0x02, 0x80, 0x80, 0x80, 0x04, 0x80, 0x80, 0x06, 0x07, 0x80, 0x80, 0x09, 0x0a, 0x80 }, // 3.1.2.2
+  { 0x00, 0x01, 0x02, 0x80, 0x80, 0x80, 0x04, 0x80, 0x80, 0x06, 0x07, 0x80, 0x09, 0x0a, 0x0b, 0x80 }, // 3.1.2.3
+  { 0x00, 0x01, 0x02, 0x80, 0x80, 0x80, 0x04, 0x80, 0x06, 0x07, 0x08, 0x80, 0x80, 0x80, 0x0a, 0x80 }, // 3.1.3.1
+  { 0x00, 0x01, 0x02, 0x80, 0x80, 0x80, 0x04, 0x80, 0x06, 0x07, 0x08, 0x80, 0x80, 0x0a, 0x0b, 0x80 }, // 3.1.3.2
+  { 0x00, 0x01, 0x02, 0x80, 0x80, 0x80, 0x04, 0x80, 0x06, 0x07, 0x08, 0x80, 0x0a, 0x0b, 0x0c, 0x80 }, // 3.1.3.3
+  { 0x00, 0x01, 0x02, 0x80, 0x80, 0x04, 0x05, 0x80, 0x80, 0x80, 0x07, 0x80, 0x80, 0x80, 0x09, 0x80 }, // 3.2.1.1
+  { 0x00, 0x01, 0x02, 0x80, 0x80, 0x04, 0x05, 0x80, 0x80, 0x80, 0x07, 0x80, 0x80, 0x09, 0x0a, 0x80 }, // 3.2.1.2
+  { 0x00, 0x01, 0x02, 0x80, 0x80, 0x04, 0x05, 0x80, 0x80, 0x80, 0x07, 0x80, 0x09, 0x0a, 0x0b, 0x80 }, // 3.2.1.3
+  { 0x00, 0x01, 0x02, 0x80, 0x80, 0x04, 0x05, 0x80, 0x80, 0x07, 0x08, 0x80, 0x80, 0x80, 0x0a, 0x80 }, // 3.2.2.1
+  { 0x00, 0x01, 0x02, 0x80, 0x80, 0x04, 0x05, 0x80, 0x80, 0x07, 0x08, 0x80, 0x80, 0x0a, 0x0b, 0x80 }, // 3.2.2.2
+  { 0x00, 0x01, 0x02, 0x80, 0x80, 0x04, 0x05, 0x80, 0x80, 0x07, 0x08, 0x80, 0x0a, 0x0b, 0x0c, 0x80 }, // 3.2.2.3
+  { 0x00, 0x01, 0x02, 0x80, 0x80, 0x04, 0x05, 0x80, 0x07, 0x08, 0x09, 0x80, 0x80, 0x80, 0x0b, 0x80 }, // 3.2.3.1
+  { 0x00, 0x01, 0x02, 0x80, 0x80, 0x04, 0x05, 0x80, 0x07, 0x08, 0x09, 0x80, 0x80, 0x0b, 0x0c, 0x80 }, // 3.2.3.2
+  { 0x00, 0x01, 0x02, 0x80, 0x80, 0x04, 0x05, 0x80, 0x07, 0x08, 0x09, 0x80, 0x0b, 0x0c, 0x0d, 0x80 }, // 3.2.3.3
+  { 0x00, 0x01, 0x02, 0x80, 0x04, 0x05, 0x06, 0x80, 0x80, 0x80, 0x08, 0x80, 0x80, 0x80, 0x0a, 0x80 }, // 3.3.1.1
+  { 0x00, 0x01, 0x02, 0x80, 0x04, 0x05, 0x06, 0x80, 0x80, 0x80, 0x08, 0x80, 0x80, 0x0a, 0x0b, 0x80 }, // 3.3.1.2
+  { 0x00, 0x01, 0x02, 0x80, 0x04, 0x05, 0x06, 0x80, 0x80, 0x80, 0x08, 0x80, 0x0a, 0x0b, 0x0c, 0x80 }, // 3.3.1.3
+  { 0x00, 0x01, 0x02, 0x80, 0x04, 0x05, 0x06, 0x80, 0x80, 0x08, 0x09, 0x80, 0x80, 0x80, 0x0b, 0x80 }, // 3.3.2.1
+  { 0x00, 0x01, 0x02, 0x80, 0x04, 0x05, 0x06, 0x80, 0x80, 0x08, 0x09, 0x80, 0x80, 0x0b, 0x0c, 0x80 }, // 3.3.2.2
+  { 0x00, 0x01, 0x02, 0x80, 0x04, 0x05, 0x06, 0x80, 0x80, 0x08, 0x09, 0x80, 0x0b, 0x0c, 0x0d, 0x80 }, // 3.3.2.3
+  { 0x00, 0x01, 0x02, 0x80, 0x04, 0x05, 0x06, 0x80, 0x08, 0x09, 0x0a, 0x80, 0x80, 0x80, 0x0c, 0x80 }, // 3.3.3.1
+  { 0x00, 0x01, 0x02, 0x80, 0x04, 0x05, 0x06, 0x80, 0x08, 0x09, 0x0a, 0x80, 0x80, 0x0c, 0x0d, 0x80 }, // 3.3.3.2
+  { 0x00, 0x01, 0x02, 0x80, 0x04, 0x05, 0x06, 0x80, 0x08, 0x09, 0x0a, 0x80, 0x0c, 0x0d, 0x0e, 0x80 }, // 3.3.3.3
+};
+
+// dotted-decimal notation (RFC 1123 section 2.1), leading zeroes are not
+// permitted, like inet_pton. the address is parsed from one vector, the
+// input must be padded
+zone_nonnull_all()
+static zone_inline bool scan_ip4(const char *data, uint8_t octets[4], size_t *length)
+{
+  const __m128i input = _mm_loadu_si128((const __m128i *)data);
+  const __m128i digits = _mm_sub_epi8(input, _mm_set1_epi8('0'));
+  const __m128i is_digit =
+    _mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits);
+  const __m128i is_dot = _mm_cmpeq_epi8(input, _mm_set1_epi8('.'));
+  uint64_t dots = (uint32_t)_mm_movemask_epi8(is_dot);
+  const uint64_t valid = dots | (uint32_t)_mm_movemask_epi8(is_digit);
+  const uint64_t count = trailing_zeroes(~valid);
+
+  // address is at most 15 characters, the last one cannot be a dot
+  dots &= (1llu << count) - 1;
+  if (count > 15 || count_ones(dots) != 3)
+    return false;
+
+  const uint64_t d0 = trailing_zeroes(dots);
+  dots = clear_lowest_bit(dots);
+  const uint64_t d1 = trailing_zeroes(dots);
+  dots = clear_lowest_bit(dots);
+  const uint64_t d2 = trailing_zeroes(dots);
+  const uint64_t g0 = d0, g1 = d1 - d0 - 1, g2 = d2 - d1 - 1, g3 = count - d2 - 1;
+
+  // each octet is one to three digits, wraps around if empty
+  if (g0 - 1 > 2 || g1 - 1 > 2 || g2 - 1 > 2 || g3 - 1 > 2)
+    return false;
+  if ((g0 > 1 && data[0] == '0') || (g1 > 1 && data[d0 + 1] == '0') ||
+      (g2 > 1 && data[d1 + 1] == '0') || (g3 > 1 && data[d2 + 1] == '0'))
+    return false;
+
+  const __m128i pattern = _mm_loadu_si128(
+    (const __m128i *)ip4_patterns[(g0 - 1) * 27 + (g1 - 1) * 9 + (g2 - 1) * 3 + (g3 - 1)]);
+  const __m128i shuffled = _mm_shuffle_epi8(digits, pattern);
+  // multiply-add hundreds and tens, then add ones
+  const __m128i weights = _mm_setr_epi8(
+    100, 10, 1, 0, 100, 10, 1, 0, 100, 10, 1, 0, 100, 10, 1, 0);
+  const __m128i pairs = _mm_maddubs_epi16(shuffled, weights);
+  const __m128i values = _mm_madd_epi16(pairs, _mm_set1_epi16(1));
+  if (_mm_movemask_epi8(_mm_cmpgt_epi32(values, _mm_set1_epi32(255))))
+    return false;
+
+  const __m128i packed = _mm_shuffle_epi8(values, _mm_setr_epi8(
+    0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1));
+  const uint32_t address = (uint32_t)_mm_cvtsi128_si32(packed);
+  memcpy(octets, &address, 4);
+  *length = (size_t)count;
+  return true;
+}
+
+zone_nonnull_all()
+static zone_inline int32_t parse_ip4(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  int32_t code;
+  size_t length;
+
+  if ((code = have_contiguous(parser, type, field, token)) < 0)
+    return code;
+  if (!scan_ip4(token->data, parser->rdata.octets + parser->rdata.length, &length))
+    return invalid_field(parser, type, field);
+  if (is_contiguous(token->data + length))
+    return invalid_field(parser, type, field);
+  parser->rdata.length += 4;
+  return 0;
+}
+
+#endif // IP4_H
@@ -0,0 +1,177 @@
+/*
+ * ip6.h -- parse IPv6 addresses
+ *
+ * Copyright (c) 2023, NLnet Labs. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#ifndef IP6_H
+#define IP6_H
+
+// longest address, i.e. eight groups or six groups and an IPv4 address
+#define IP6_MAX_LENGTH (45)
+
+typedef struct ip6_block ip6_block_t;
+struct ip6_block {
+  uint64_t hex;
+  uint64_t colons;
+  uint64_t dots;
+  // nibble value of each hex digit, preceded by four zeroes so that the
+  // last four digits of any group can be loaded at once
+  uint8_t nibbles[4 + 64];
+};
+
+// classify hex digits, colons and dots and convert hex digits to nibbles
+// for 64 octets at once, input must be padded
+zone_nonnull_all()
+static zone_inline void classify_ip6(ip6_block_t *block, const char *data)
+{
+  memset(block->nibbles, 0, 4);
+  for (size_t i=0; i < 2; i++) {
+    const __m256i input = _mm256_loadu_si256((const __m256i *)(data + i*32));
+    const __m256i digits = _mm256_sub_epi8(input, _mm256_set1_epi8('0'));
+    const __m256i letters = _mm256_sub_epi8(
+      _mm256_or_si256(input, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    const __m256i is_digit = _mm256_cmpeq_epi8(
+      _mm256_min_epu8(digits, _mm256_set1_epi8(9)), digits);
+    const __m256i is_letter = _mm256_cmpeq_epi8(
+      _mm256_min_epu8(letters, _mm256_set1_epi8(5)), letters);
+    const __m256i nibbles = _mm256_blendv_epi8(
+      _mm256_add_epi8(letters, _mm256_set1_epi8(10)), digits, is_digit);
+    const uint64_t hex =
+      (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(is_digit, is_letter));
+    const uint64_t colons = (uint32_t)_mm256_movemask_epi8(
+      _mm256_cmpeq_epi8(input, _mm256_set1_epi8(':')));
+    const uint64_t dots = (uint32_t)_mm256_movemask_epi8(
+      _mm256_cmpeq_epi8(input, _mm256_set1_epi8('.')));
+    block->hex = i ? block->hex | (hex << 32) : hex;
+    block->colons = i ? block->colons | (colons << 32) : colons;
+    block->dots = i ? block->dots | (dots << 32) : dots;
+    _mm256_storeu_si256((__m256i *)&block->nibbles[4 + i*32], nibbles);
+  }
+}
+
+// convert the groups in [start, end), separated by single colons, to wire
+// format. returns the number of groups or -1 if a group is empty, has more
+// than four digits or if there are more than limit groups
+zone_nonnull_all()
+static zone_inline int32_t scan_ip6_groups(
+  const ip6_block_t *block,
+  uint64_t start,
+  uint64_t end,
+  int32_t limit,
+  uint8_t *octets)
+{
+  uint64_t colons = block->colons & ((1llu << end) - 1) & ~((1llu << start) - 1);
+  int32_t count = 0;
+
+  if (start == end)
+    return 0;
+
+  for (;;) {
+    const uint64_t stop = colons ? trailing_zeroes(colons) : end;
+    const uint64_t digits = stop - start;
+    // an address has at most eight groups, stated for the compiler too
+    if (digits - 1 > 3 || count >= limit || count >= 8)
+      return -1;
+    // load last four digits, zero digits that belong to previous groups
+    uint32_t group;
+    memcpy(&group, &block->nibbles[stop], 4);
+    group &= 0xffffffffu << (8 * (4 - digits));
+    group = ((group & 0x000f000fu) << 4) | ((group >> 8) & 0x000f000fu);
+    octets[2*count] = (uint8_t)group;
+    octets[2*count+1] = (uint8_t)(group >> 16);
+    count++;
+    if (stop == end)
+      return count;
+    start = stop + 1;
+    colons = clear_lowest_bit(colons);
+  }
+}
+
+// text representation (RFC 4291 section 2.2), including "::" compression
+// and an embedded IPv4 address. the input is classified and converted in
+// one pass, groups are converted four nibbles at a time
+zone_nonnull_all()
+static zone_inline bool scan_ip6(const char *data, uint8_t octets[16], size_t *length)
+{
+  ip6_block_t block;
+  uint64_t end, gap;
+  int32_t groups = 8, left, right;
+  uint8_t wire[16];
+
+  classify_ip6(&block, data);
+  const uint64_t valid = block.hex | block.colons | block.dots;
+  if (!~valid)
+    return false;
+  const uint64_t count = trailing_zeroes(~valid);
+  if (count > IP6_MAX_LENGTH || count < 2)
+    return false;
+
+  const uint64_t mask = (1llu << count) - 1;
+  block.colons &= mask;
+  block.dots &= mask;
+  end = count;
+
+  // embedded IPv4 address follows the last colon before the first dot
+  if (block.dots) {
+    const uint64_t colons = block.colons & ((1llu << trailing_zeroes(block.dots)) - 1);
+    size_t tail;
+    if (!colons)
+      return false;
+    const uint64_t start = 64 - leading_zeroes(colons);
+    if (!scan_ip4(data + start, &wire[12], &tail) || start + tail != count)
+      return false;
+    // separating colon is part of "::" if directly preceded by a colon
+    end = (start >= 2 && data[start - 2] == ':') ? start : start - 1;
+    block.colons &= (1llu << end) - 1;
+    groups = 6;
+  }
+
+  // "::" may appear at most once
+  gap = block.colons & (block.colons >> 1);
+  if (gap) {
+    if (clear_lowest_bit(gap))
+      return false;
+    const uint64_t at = trailing_zeroes(gap);
+    // groups after the gap are right-aligned, count them up front
+    right = at + 2 == end ? 0 : (int32_t)count_ones(block.colons >> (at + 2)) + 1;
+    if (right >= groups)
+      return false;
+    memset(wire, 0, (size_t)(2*groups));
+    if ((left = scan_ip6_groups(&block, 0, at, groups - 1 - right, wire)) < 0)
+      return false;
+    if (scan_ip6_groups(&block, at + 2, end, right, &wire[2*(groups - right)]) != right)
+      return false;
+  } else {
+    if (scan_ip6_groups(&block, 0, end, groups, wire) != groups)
+      return false;
+  }
+
+  memcpy(octets, wire, 16);
+  *length = (size_t)count;
+  return true;
+}
+
+zone_nonnull_all()
+static zone_inline int32_t parse_ip6(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  int32_t code;
+  size_t length;
+
+  if ((code = have_contiguous(parser, type, field, token)) < 0)
+    return code;
+  if (!scan_ip6(token->data, parser->rdata.octets + parser->rdata.length, &length))
+    return invalid_field(parser, type, field);
+  if (is_contiguous(token->data + length))
+    return invalid_field(parser, type, field);
+  parser->rdata.length += 16;
+  return 0;
+}
+
+#endif // IP6_H
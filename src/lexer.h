@@ -27,11 +27,19 @@ struct token {
 
 #define STRING (CONTIGUOUS | QUOTED)
 
+// errors are stored in the token so that callers need not check the return
+// value of lex
+#define LEX_ERROR(parser, token, ...) \
+  do { \
+    return (token)->code = zone_raise( \
+      parser, __FILE__, __LINE__, __func__, ZONE_SYNTAX_ERROR, __VA_ARGS__); \
+  } while (0)
+
 static const uint8_t classify[256] = {
   // 0x00 = "\0"
   0x00, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02,  // 0x00 - 0x07
   // 0x09 = "\t", 0x0a = "\n", 0x0d = "\r"
-  0x30, 0x20, 0x01, 0x02, 0x02, 0x30, 0x02, 0x02,  // 0x08 - 0x0f
+  0x02, 0x30, 0x01, 0x02, 0x02, 0x30, 0x02, 0x02,  // 0x08 - 0x0f
   0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02,  // 0x10 - 0x17
   0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02,  // 0x18 - 0x1f
   // 0x20 = " ", 0x22 = "\""
@@ -40,7 +48,7 @@ static const uint8_t classify[256] = {
   0x10, 0x20, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02,  // 0x28 - 0x2f
   0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02,  // 0x30 - 0x37
   // 0x3b = ";"
-  0x02, 0x02, 0x40, 0x02, 0x02, 0x02, 0x02, 0x02,  // 0x38 - 0x3f
+  0x02, 0x02, 0x02, 0x40, 0x02, 0x02, 0x02, 0x02,  // 0x38 - 0x3f
   0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02,  // 0x40 - 0x47
   0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02,  // 0x48 - 0x4f
   0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02,  // 0x50 - 0x57
@@ -189,18 +197,19 @@ static zone_inline int32_t lex(zone_parser_t *parser, token_t *token)
         parser->file->start_of_line = classify[ (uint8_t)*(token->data+1) ] != BLANK;
         return token->code = LINE_FEED;
       case '\"':
+        // closing quote is indexed too, tape never contains partial tokens
         token->data++;
-        parser->file->indexer.head++;
+        parser->file->indexer.head += 2;
         return token->code = QUOTED;
       case '(':
         if (parser->file->grouped)
-          SYNTAX_ERROR(parser, "Nested opening brace");
+          LEX_ERROR(parser, token, "Nested opening brace");
         parser->file->indexer.head++;
         parser->file->grouped = true;
         break;
       case ')':
         if (!parser->file->grouped)
-          SYNTAX_ERROR(parser, "Missing opening brace");
+          LEX_ERROR(parser, token, "Missing opening brace");
         parser->file->indexer.head++;
         parser->file->grouped = false;
         break;
@@ -211,4 +220,36 @@ static zone_inline int32_t lex(zone_parser_t *parser, token_t *token)
   }
 }
 
+// contiguous tokens are terminated by the first character that is not
+// contiguous, escaped characters are contiguous
+zone_nonnull_all()
+static zone_inline bool is_contiguous(const char *data)
+{
+  return classify[ (uint8_t)*data ] == CONTIGUOUS;
+}
+
+// quoted tokens are terminated by the first unescaped quote, the terminator
+// is checked for unterminated quoted tokens at the end of the input
+zone_nonnull_all()
+static zone_inline bool is_quoted(const char *data)
+{
+  return *data != '\"' && *data != '\0';
+}
+
+zone_nonnull_all()
+static zone_inline size_t token_length(const token_t *token)
+{
+  const char *data = token->data;
+
+  if (token->code == QUOTED) {
+    while (is_quoted(data))
+      data += 1 + (*data == '\\' && data[1] != '\0');
+  } else {
+    while (is_contiguous(data))
+      data += 1 + (*data == '\\' && data[1] != '\0');
+  }
+
+  return (size_t)(data - token->data);
+}
+
 #endif // LEXER_H
@@ -0,0 +1,187 @@
+/*
+ * loc.h -- parse location fields (RFC 1876)
+ *
+ * Copyright (c) 2023, NLnet Labs. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#ifndef LOC_H
+#define LOC_H
+
+// decimal number with at most digits fraction digits, scaled by 10^digits,
+// e.g. 2.5 with two fraction digits is 250
+zone_nonnull_all()
+static zone_inline bool scan_decimal(
+  const char *data, size_t digits, uint64_t *number, size_t *length)
+{
+  uint64_t digit, value = 0;
+  size_t count = 0, fraction = 0;
+
+  while ((digit = (uint8_t)(data[count] - '0')) <= 9) {
+    if (count == 10)
+      return false;
+    value = value * 10 + digit;
+    count++;
+  }
+
+  if (!count)
+    return false;
+
+  if (data[count] == '.') {
+    count++;
+    while ((digit = (uint8_t)(data[count] - '0')) <= 9) {
+      if (fraction == digits)
+        return false;
+      value = value * 10 + digit;
+      fraction++;
+      count++;
+    }
+    if (!fraction)
+      return false;
+  }
+
+  for (; fraction < digits; fraction++)
+    value *= 10;
+  *number = value;
+  *length = count;
+  return true;
+}
+
+// degrees, optional minutes and seconds and hemisphere, stored as
+// thousandths of a second of arc offset by 2^31 (RFC 1876 section 2). token
+// is the hemisphere on return
+zone_nonnull_all()
+static zone_inline int32_t parse_coordinate(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token,
+  uint64_t maximum,
+  const char hemispheres[2])
+{
+  int32_t code;
+  uint64_t degrees, minutes = 0, seconds = 0;
+  size_t length;
+
+  if ((code = scan_int(parser, type, field, token, maximum, &degrees)) < 0)
+    return code;
+  lex(parser, token);
+  if (token->code == CONTIGUOUS && (uint8_t)(token->data[0] - '0') <= 9) {
+    if ((code = scan_int(parser, type, field, token, 59, &minutes)) < 0)
+      return code;
+    lex(parser, token);
+    if (token->code == CONTIGUOUS && (uint8_t)(token->data[0] - '0') <= 9) {
+      if (!scan_decimal(token->data, 3, &seconds, &length) ||
+          is_contiguous(token->data + length) || seconds > 59999)
+        return invalid_field(parser, type, field);
+      lex(parser, token);
+    }
+  }
+
+  if ((code = have_contiguous(parser, type, field, token)) < 0)
+    return code;
+  if (is_contiguous(token->data + 1))
+    return invalid_field(parser, type, field);
+
+  const uint64_t arc = ((degrees * 60 + minutes) * 60) * 1000 + seconds;
+  const char hemisphere = (char)(token->data[0] | 0x20);
+  if (arc > maximum * 3600 * 1000)
+    return invalid_field(parser, type, field);
+  if (hemisphere != hemispheres[0] && hemisphere != hemispheres[1])
+    return invalid_field(parser, type, field);
+
+  const uint32_t offset = 1u << 31;
+  write_int32(parser->rdata.octets + parser->rdata.length,
+    hemisphere == hemispheres[0] ? offset + (uint32_t)arc : offset - (uint32_t)arc);
+  parser->rdata.length += 4;
+  return 0;
+}
+
+zone_nonnull_all()
+static zone_inline int32_t parse_latitude(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  return parse_coordinate(parser, type, field, token, 90, "ns");
+}
+
+zone_nonnull_all()
+static zone_inline int32_t parse_longitude(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  return parse_coordinate(parser, type, field, token, 180, "ew");
+}
+
+// meters with an optional "m" suffix, stored as centimeters above a base
+// of 100000 meters below the reference spheroid
+zone_nonnull_all()
+static zone_inline int32_t parse_altitude(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  int32_t code;
+  uint64_t altitude;
+  size_t length;
+  const char *data = token->data;
+  const uint64_t base = 10000000;
+
+  if ((code = have_contiguous(parser, type, field, token)) < 0)
+    return code;
+
+  const bool negative = *data == '-';
+  data += negative;
+  if (!scan_decimal(data, 2, &altitude, &length))
+    return invalid_field(parser, type, field);
+  length += data[length] == 'm';
+  if (is_contiguous(data + length))
+    return invalid_field(parser, type, field);
+  if (negative ? altitude > base : altitude > UINT32_MAX - base)
+    return invalid_field(parser, type, field);
+
+  altitude = negative ? base - altitude : base + altitude;
+  write_int32(parser->rdata.octets + parser->rdata.length, (uint32_t)altitude);
+  parser->rdata.length += 4;
+  return 0;
+}
+
+// meters with an optional "m" suffix, stored as centimeters in a mantissa
+// and power of ten of four bits each, e.g. 0x12 for 1m
+zone_nonnull_all()
+static zone_inline int32_t scan_precision(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  const token_t *token,
+  uint8_t *octet)
+{
+  int32_t code;
+  uint64_t precision, power = 1;
+  uint8_t exponent = 0;
+  size_t length;
+
+  if ((code = have_contiguous(parser, type, field, token)) < 0)
+    return code;
+  if (!scan_decimal(token->data, 2, &precision, &length))
+    return invalid_field(parser, type, field);
+  length += token->data[length] == 'm';
+  if (is_contiguous(token->data + length) || precision > 9000000000llu)
+    return invalid_field(parser, type, field);
+
+  while (exponent < 9 && precision >= power * 10) {
+    power *= 10;
+    exponent++;
+  }
+
+  *octet = (uint8_t)(((precision / power) << 4) | exponent);
+  return 0;
+}
+
+#endif // LOC_H
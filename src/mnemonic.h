@@ -0,0 +1,56 @@
+/*
+ * mnemonic.h -- load mnemonics for perfect hash lookups
+ *
+ * Copyright (c) 2023, NLnet Labs. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#ifndef MNEMONIC_H
+#define MNEMONIC_H
+
+// 16 octets of 0xff followed by 16 octets of 0x00 to mask input by length
+static const uint8_t mnemonic_masks[32] = {
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+// load mnemonic as two words, octets from the first delimiter onwards are
+// cleared. the length is taken from the delimiters in the same 16 octets,
+// separator ends the mnemonic too, e.g. '=' for key=value. loads 16 octets
+// regardless of length, input must be padded. mnemonics are shorter than 16
+// octets, false is returned if no delimiter is found
+zone_nonnull_all()
+static zone_inline bool load_mnemonic(
+  const char *data, char separator, uint64_t input[2], size_t *length)
+{
+  const delimiter_table_t *table = &delimiters[CONTIGUOUS];
+  uint64_t mask[2];
+  simd_8x16_t simd;
+
+  simd_loadu_8x16(&simd, (const uint8_t *)data);
+  const uint64_t delimiter = simd_find_any_8x16(&simd, table->special) |
+                             simd_find_any_8x16(&simd, table->blank) |
+                             simd_find_8x16(&simd, separator);
+  if (!delimiter)
+    return false;
+
+  *length = trailing_zeroes(delimiter);
+  memcpy(input, data, 16);
+  memcpy(mask, &mnemonic_masks[16 - *length], 16);
+  input[0] &= mask[0];
+  input[1] &= mask[1];
+  return true;
+}
+
+// multiplicative hash, the magic value and the number of bits are chosen per
+// table so that no two mnemonics collide
+zone_nonnull_all()
+static zone_inline size_t hash_mnemonic(
+  const uint64_t input[2], uint64_t magic, uint8_t bits)
+{
+  return (size_t)(((input[0] ^ input[1]) * magic) >> (64 - bits));
+}
+
+#endif // MNEMONIC_H
@@ -1,5 +1,5 @@
 /*
- * name.h -- some useful comment
+ * name.h -- parse domain names
  *
  * Copyright (c) 2022-2023, NLnet Labs. All rights reserved.
  *
@@ -9,110 +9,407 @@
 #ifndef NAME_H
 #define NAME_H
 
-struct name_block {
-  size_t length;
-  uint64_t escape_bits;
-  uint64_t label_bits;
-};
+// decode \X or \DDD (RFC 1035 section 5.1), returns number of characters
+// consumed or 0 if the escape sequence is invalid
+zone_nonnull_all()
+static zone_inline size_t unescape(const char *data, uint8_t *octet)
+{
+  const uint32_t d0 = (uint8_t)(data[1] - '0');
 
+  if (d0 > 9) {
+    if (data[1] == '\0')
+      return 0;
+    *octet = (uint8_t)data[1];
+    return 2;
+  }
+
+  const uint32_t d1 = (uint8_t)(data[2] - '0');
+  const uint32_t d2 = (uint8_t)(data[3] - '0');
+  const uint32_t number = d0 * 100 + d1 * 10 + d2;
+  if (d1 > 9 || d2 > 9 || number > 255)
+    return 0;
+  *octet = (uint8_t)number;
+  return 4;
+}
+
+// canonical form (RFC 4034 section 6.2) requires upper case letters to be
+// converted to lower case for the owner and names in RDATA of listed types.
+// the list is recorded in the field descriptors, the next domain name of
+// NSEC is no longer converted (RFC 6840 section 5.1)
 zone_nonnull_all()
-static zone_inline copy_name_block(
-  name_block_t *block,
-  simd_table_t blank,
-  simd_table_t special,
-  const char *text,
-  uint8_t *wire)
+static zone_inline bool is_canonical(
+  const zone_parser_t *parser, const field_info_t *field)
+{
+  return parser->options.canonical && (field->qualifiers & CANONICAL);
+}
+
+// label lengths never exceed 63 and therefore blocks in wire format can be
+// converted as is
+zone_nonnull_all()
+static zone_inline void lower_8x(simd_8x_t *input)
+{
+  const __m256i above = _mm256_cmpgt_epi8(input->chunks[0], _mm256_set1_epi8('A' - 1));
+  const __m256i below = _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), input->chunks[0]);
+  const __m256i upper = _mm256_and_si256(above, below);
+  input->chunks[0] = _mm256_or_si256(
+    input->chunks[0], _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+}
+
+// origin is kept in a padded buffer and names are scanned into padded
+// buffers, copy in blocks rather than exact length
+zone_nonnull_all()
+static zone_inline void copy_origin(
+  uint8_t *wire, const zone_name_buffer_t *origin, bool canonical)
 {
   simd_8x_t input;
 
-  simd_loadu_8x(&input, text);
-  simd_storeu_8x(wire, &input);
+  for (size_t count = 0; count < origin->length; count += SIMD_8X_SIZE) {
+    simd_loadu_8x(&input, origin->octets + count);
+    if (canonical)
+      lower_8x(&input);
+    simd_storeu_8x(wire + count, &input);
+  }
+}
 
-  const uint64_t bits = simd_find_any_8x(&input, blank) |
-                        simd_find_any_8x(&input, special);
-  const uint64_t mask = (-bits & bits) - 1;
-  block->length = count_ones(mask);
-  block->escape_bits = simd_find_8x(&input, '\\') & mask;
-  block->label_bits = simd_find_8x(&input, '.') & mask;
+// complete the name, label is the length octet of the last label. relative
+// names are completed by appending the origin in wire format
+zone_nonnull_all()
+static zone_inline int32_t finish_name(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  uint8_t *octets,
+  uint8_t *label,
+  uint8_t *wire,
+  size_t *length)
+{
+  const zone_name_buffer_t *origin = &parser->file->origin;
+  const size_t count = (size_t)(wire - label) - 1;
+
+  if (count > 63)
+    return invalid_field(parser, type, field);
+  *label = (uint8_t)count;
+  if (!count) {
+    *length = (size_t)(wire - octets);
+    return 0;
+  }
+
+  // relative name, append origin
+  if ((size_t)(wire - octets) + origin->length > 255)
+    return invalid_field(parser, type, field);
+  copy_origin(wire, origin, is_canonical(parser, field));
+  *length = (size_t)(wire - octets) + origin->length;
+  return 0;
+}
+
+// gather the octets selected by keep (16 bits) from block, shuffle indices
+// are compacted eight at a time with pext. writes 16 octets, returns the
+// number of octets kept
+zone_nonnull_all()
+static zone_inline size_t compact_block(
+  const uint8_t *block, uint32_t keep, uint8_t *wire)
+{
+  const uint64_t lo = _pext_u64(
+    0x0706050403020100llu, _pdep_u64(keep, 0x0101010101010101llu) * 0xff);
+  const uint64_t hi = _pext_u64(
+    0x0f0e0d0c0b0a0908llu, _pdep_u64(keep >> 8, 0x0101010101010101llu) * 0xff);
+  const __m128i input = _mm_loadu_si128((const __m128i *)block);
+  const __m128i indices = _mm_set_epi64x((long long)hi, (long long)lo);
+  uint64_t words[2];
+
+  _mm_storeu_si128((__m128i *)words, _mm_shuffle_epi8(input, indices));
+  memcpy(wire, &words[0], 8);
+  memcpy(wire + count_ones(keep & 0xff), &words[1], 8);
+  return (size_t)count_ones(keep & 0xffff);
 }
 
+// names with escape sequences are decoded SIMD_8X_SIZE characters at a
+// time. escape sequences are located and decoded in place, the value replaces
+// the last character of the sequence, the characters that remain are
+// compacted with a shuffle. escape sequences that cross the end of the block
+// are left for the next block. decoding resumes where scan_name encountered
+// the first escape sequence
 zone_nonnull_all()
-static zone_inline zone_return_t scan_name(
+static zone_no_inline int32_t scan_escaped_name(
   zone_parser_t *parser,
-  const zone_type_info_t *type,
-  const zone_field_info_t *field,
-  zone_token_t *token,
-  uint8_t octets[255 + ZONE_BLOCK_SIZE],
+  const type_info_t *type,
+  const field_info_t *field,
+  const token_t *token,
+  const char *data,
+  uint8_t *octets,
+  uint8_t *label,
+  uint8_t *wire,
   size_t *length)
 {
-  name_block_t block;
-  uint8_t *wire = octets + 1, *label = octets;
-  const uint8_t *blank, *special;
-  const char *text = token->data;
+  const delimiter_table_t *table =
+    &delimiters[token->code == QUOTED ? QUOTED : CONTIGUOUS];
+  uint8_t block[SIMD_8X_SIZE];
+  simd_8x_t input;
 
-  // based on the token code we set the blank and special tables
+  for (;;) {
+    simd_loadu_8x(&input, data);
+    simd_storeu_8x(block, &input);
+    uint64_t delimiter = simd_find_any_8x(&input, table->special) |
+                         simd_find_any_8x(&input, table->blank);
+    uint64_t dots = simd_find_8x(&input, '.');
+    uint64_t keep = 0xffffffff, escaped = 0, limit = SIMD_8X_SIZE;
 
-  do {
-    copy_name_block(&block, blank, special, wire, text);
+    for (uint64_t bits = simd_find_8x(&input, '\\'); bits; ) {
+      const uint64_t index = trailing_zeroes(bits);
+      if (delimiter & ~escaped & ((1llu << index) - 1))
+        break;
+      // \DDD requires four characters
+      if (index > SIMD_8X_SIZE - 4) {
+        limit = index;
+        break;
+      }
+      uint8_t octet;
+      const size_t count = unescape(data + index, &octet);
+      if (!count)
+        return invalid_field(parser, type, field);
+      const uint64_t last = index + count - 1;
+      block[last] = octet;
+      keep &= ~(((1llu << (count - 1)) - 1) << index);
+      escaped |= 1llu << last;
+      bits &= ~((2llu << last) - 1);
+    }
 
-    if (block.escape_bits) {
-    } else {
-      text += block.length;
-      wire += block.length;
+    // decoded octets are converted too
+    if (is_canonical(parser, field)) {
+      simd_loadu_8x(&input, block);
+      lower_8x(&input);
+      simd_storeu_8x(block, &input);
     }
 
-    if (block.label_bits) {
-      //
-    } else {
-      *label += (uint8_t)block.length;
-      if (*label > 63)
-        SYNTAX_ERROR(parser, "Bad domain name in %s of %s",
-                     field->name.data, type->name.data);
+    delimiter &= ~escaped;
+    const uint64_t stop = delimiter ? trailing_zeroes(delimiter) : SIMD_8X_SIZE;
+    const uint64_t end = stop < limit ? stop : limit;
+    keep &= (1llu << end) - 1;
+    dots &= ~escaped & keep;
+
+    const size_t count = compact_block(block, (uint32_t)keep, wire);
+    compact_block(block + 16, (uint32_t)(keep >> 16), wire + count);
+
+    for (uint64_t bits = _pext_u64(dots, keep); bits; bits = clear_lowest_bit(bits)) {
+      uint8_t *dot = wire + trailing_zeroes(bits);
+      const size_t count = (size_t)(dot - label) - 1;
+      if (!count || count > 63)
+        return invalid_field(parser, type, field);
+      *label = (uint8_t)count;
+      label = dot;
     }
-  } while (block.length);
 
-  //
-  // >> determine the type of table we require...
-  //
-  // implement
-  //
+    wire += count_ones(keep);
+    data += end;
+    if (wire > octets + 255)
+      return invalid_field(parser, type, field);
+    if (delimiter && stop <= limit)
+      break;
+  }
+
+  return finish_name(parser, type, field, octets, label, wire, length);
 }
 
+// reverse names, i.e. ip6.arpa with single nibble labels and in-addr.arpa
+// with short numeric labels, have many labels per block. lengths for all
+// dots in the block are computed at once, the position of the next dot is
+// found by a suffix minimum over dot positions and the lengths are blended
+// into the text in place of the dots. the length of the last label in the
+// block is written once its end is known
 zone_nonnull_all()
-static zone_inline zone_return_t parse_name(
+static zone_inline void copy_labels(uint8_t *wire, const simd_8x_t *input)
+{
+  const __m256i positions = _mm256_setr_epi8(
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15,
+    16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31);
+  const __m256i none = _mm256_set1_epi8(64);
+  const __m256i dots = _mm256_cmpeq_epi8(input->chunks[0], _mm256_set1_epi8('.'));
+  __m256i next = _mm256_blendv_epi8(none, positions, dots);
+  __m256i high;
+
+  // shift down by one octet so that every position sees the next dot
+  high = _mm256_permute2x128_si256(next, none, 0x21);
+  next = _mm256_alignr_epi8(high, next, 1);
+  high = _mm256_permute2x128_si256(next, none, 0x21);
+  next = _mm256_min_epu8(next, _mm256_alignr_epi8(high, next, 1));
+  high = _mm256_permute2x128_si256(next, none, 0x21);
+  next = _mm256_min_epu8(next, _mm256_alignr_epi8(high, next, 2));
+  high = _mm256_permute2x128_si256(next, none, 0x21);
+  next = _mm256_min_epu8(next, _mm256_alignr_epi8(high, next, 4));
+  high = _mm256_permute2x128_si256(next, none, 0x21);
+  next = _mm256_min_epu8(next, _mm256_alignr_epi8(high, next, 8));
+  next = _mm256_min_epu8(next, _mm256_permute2x128_si256(next, none, 0x21));
+
+  const __m256i lengths = _mm256_sub_epi8(
+    _mm256_sub_epi8(next, positions), _mm256_set1_epi8(1));
+  _mm256_storeu_si256(
+    (__m256i *)wire, _mm256_blendv_epi8(input->chunks[0], lengths, dots));
+}
+
+// text is copied SIMD_8X_SIZE characters at a time to one past the start of
+// the name, which puts every dot in place of the length octet of the label
+// that follows it. lengths are the differences between consecutive dot
+// positions. escape sequences are rare and handled by a separate path
+zone_nonnull_all()
+static zone_inline int32_t scan_name(
   zone_parser_t *parser,
-  zone_type_info_t *type,
-  zone_field_info_t *field,
-  zone_token_t *token)
+  const type_info_t *type,
+  const field_info_t *field,
+  const token_t *token,
+  uint8_t octets[255 + ZONE_BLOCK_SIZE],
+  size_t *length)
 {
-  zone_return_t error;
+  const zone_name_buffer_t *origin = &parser->file->origin;
+  const bool quoted = token->code == QUOTED;
+  const delimiter_table_t *table = &delimiters[quoted ? QUOTED : CONTIGUOUS];
+  const char *data = token->data;
+  const bool canonical = is_canonical(parser, field);
+  uint8_t *label = octets, *wire = octets + 1;
+  simd_8x_t input;
+
+  // "@" denotes the origin, "." denotes the root
+  if ((data[0] == '@' || data[0] == '.') &&
+      !(quoted ? is_quoted(data + 1) : is_contiguous(data + 1)))
+  {
+    if (data[0] == '.') {
+      octets[0] = 0;
+      *length = 1;
+    } else {
+      copy_origin(octets, origin, canonical);
+      *length = origin->length;
+    }
+    return 0;
+  }
 
-  if ((error = have_string(type, field, token)))
-    return error;
+  for (;;) {
+    simd_loadu_8x(&input, data);
+    if (canonical)
+      lower_8x(&input);
+    simd_storeu_8x(wire, &input);
+    const uint64_t delimiter = simd_find_any_8x(&input, table->special) |
+                               simd_find_any_8x(&input, table->blank);
+    const uint64_t mask = (delimiter & -delimiter) - 1;
+    const uint64_t escapes = simd_find_8x(&input, '\\') & mask;
+    uint64_t dots = simd_find_8x(&input, '.') & mask;
 
-  //
-  // implement
-  //
+    if (zone_unlikely(escapes))
+      return scan_escaped_name(
+        parser, type, field, token, data, octets, label, wire, length);
+
+    if (count_ones(dots) > 2) {
+      // empty labels, consecutive dots within the block
+      if (dots & (dots >> 1))
+        return invalid_field(parser, type, field);
+      copy_labels(wire, &input);
+      uint8_t *dot = wire + trailing_zeroes(dots);
+      const size_t count = (size_t)(dot - label) - 1;
+      if (!count || count > 63)
+        return invalid_field(parser, type, field);
+      *label = (uint8_t)count;
+      label = wire + (63 - leading_zeroes(dots));
+      dots = 0;
+    }
+
+    for (; dots; dots = clear_lowest_bit(dots)) {
+      uint8_t *dot = wire + trailing_zeroes(dots);
+      const size_t count = (size_t)(dot - label) - 1;
+      if (!count || count > 63)
+        return invalid_field(parser, type, field);
+      *label = (uint8_t)count;
+      label = dot;
+    }
 
-  return ZONE_NAME;
+    if (delimiter) {
+      wire += trailing_zeroes(delimiter);
+      break;
+    }
+    wire += SIMD_8X_SIZE;
+    data += SIMD_8X_SIZE;
+    if (wire > octets + 255)
+      return invalid_field(parser, type, field);
+  }
+
+  if (wire > octets + 255 || wire == octets + 1)
+    return invalid_field(parser, type, field);
+  return finish_name(parser, type, field, octets, label, wire, length);
 }
 
-static zone_inline zone_return_t parse_owner(
+zone_nonnull_all()
+static zone_inline int32_t parse_name(
   zone_parser_t *parser,
-  zone_type_info_t *type,
-  zone_field_info_t *field,
-  zone_token_t *token)
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  int32_t code;
+  size_t length = 0;
+
+  if ((code = have_string(parser, type, field, token)) < 0)
+    return code;
+  if ((code = scan_name(parser, type, field, token,
+                        parser->rdata.octets + parser->rdata.length, &length)) < 0)
+    return code;
+  parser->rdata.length += length;
+  return 0;
+}
+
+// owners in sorted zones are often repeated. the text of the last owner
+// is retained and compared a block at a time, text is retained only if it
+// is free of escape sequences and the origin did not change
+zone_nonnull_all()
+static zone_inline bool retain_owner(
+  zone_parser_t *parser, const token_t *token, size_t *length)
 {
-  zone_return_t error;
+  const delimiter_table_t *table = &delimiters[token->code == QUOTED ? QUOTED : CONTIGUOUS];
+  uint64_t different = token->code != parser->last_owner.code;
+  simd_8x_t input, last;
 
-  if ((error = have_string(type, field, token)))
-    return error;
+  *length = 0;
+  for (size_t offset = 0; offset < 255; offset += SIMD_8X_SIZE) {
+    simd_loadu_8x(&input, token->data + offset);
+    simd_loadu_8x(&last, parser->last_owner.data + offset);
+    simd_storeu_8x(parser->last_owner.data + offset, &input);
+    const uint64_t delimiter = simd_find_any_8x(&input, table->special) |
+                               simd_find_any_8x(&input, table->blank);
+    const uint64_t mask = ((delimiter & -delimiter) - 1) & 0xffffffffu;
+    if (simd_find_8x(&input, '\\') & mask)
+      return false;
+    different |= ~simd_equal_8x(&input, &last) & mask;
+    if (delimiter) {
+      *length = offset + trailing_zeroes(delimiter);
+      return !different && *length == parser->last_owner.length;
+    }
+  }
+
+  return false;
+}
+
+zone_nonnull_all()
+static zone_inline int32_t parse_owner(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  int32_t code;
+  size_t length;
+  zone_name_buffer_t *owner;
 
-  //
-  // implement
-  //
+  if ((code = have_string(parser, type, field, token)) < 0)
+    return code;
+  if (retain_owner(parser, token, &length) && length) {
+    parser->same_owner = true;
+    return 0;
+  }
 
-  return ZONE_NAME;
+  parser->same_owner = false;
+  parser->last_owner.code = token->code;
+  parser->last_owner.length = 0;
+  owner = claim_owner(parser);
+  if ((code = scan_name(parser, type, field, token, owner->octets, &owner->length)) < 0)
+    return code;
+  parser->last_owner.length = length;
+  return 0;
 }
 
 #endif // NAME_H
@@ -0,0 +1,97 @@
+/*
+ * nsec.h -- parse type bitmaps
+ *
+ * Copyright (c) 2023, NLnet Labs. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#ifndef NSEC_H
+#define NSEC_H
+
+// maximum length of a type bitmap, 256 windows of 32 octets
+#define TYPE_BITMAP_SIZE (256 * (2 + 32))
+
+// type bitmap that makes up the remainder of the RDATA (RFC 4034 section
+// 4.1.2), the bitmap may be empty. consumes all tokens, token is the
+// delimiter on return. the scratch bitmap is not cleared up front, windows
+// are cleared when first touched and only touched windows are emitted
+zone_nonnull_all()
+static zone_inline int32_t parse_nsec(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  int32_t code;
+  uint8_t windows[256][32];
+  uint8_t lengths[256];
+  uint64_t touched[4] = { 0, 0, 0, 0 };
+  uint8_t *wire = parser->rdata.octets + parser->rdata.length;
+
+  while (token->code == CONTIGUOUS) {
+    uint16_t number = 0;
+    if ((code = scan_type(parser, type, field, token, &number)) < 0)
+      return code;
+    const uint8_t window = (uint8_t)(number >> 8);
+    const uint8_t block = (uint8_t)((number & 0xff) >> 3);
+    const uint64_t bit = 1llu << (window & 0x3f);
+    if (!(touched[window >> 6] & bit)) {
+      touched[window >> 6] |= bit;
+      memset(windows[window], 0, sizeof(windows[window]));
+      lengths[window] = 0;
+    }
+    windows[window][block] |= (uint8_t)(0x80 >> (number & 0x7));
+    if (lengths[window] < block + 1)
+      lengths[window] = (uint8_t)(block + 1);
+    lex(parser, token);
+  }
+
+  for (size_t i=0; i < 4; i++) {
+    for (uint64_t bits = touched[i]; bits; bits = clear_lowest_bit(bits)) {
+      const size_t window = i * 64 + (size_t)trailing_zeroes(bits);
+      wire[0] = (uint8_t)window;
+      wire[1] = lengths[window];
+      memcpy(wire + 2, windows[window], lengths[window]);
+      wire += 2 + lengths[window];
+    }
+  }
+
+  parser->rdata.length = (size_t)(wire - parser->rdata.octets);
+  return 0;
+}
+
+// type bitmap of NXT (RFC 2535 section 5.2), one bit per type for types 1
+// to 127 without trailing zero octets. bit zero indicates another format
+// and is never set. consumes all tokens, token is the delimiter on return
+zone_nonnull_all()
+static zone_inline int32_t parse_nxt(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  int32_t code;
+  uint8_t *wire = parser->rdata.octets + parser->rdata.length;
+  size_t length = 0;
+
+  while (token->code == CONTIGUOUS) {
+    uint16_t number = 0;
+    if ((code = scan_type(parser, type, field, token, &number)) < 0)
+      return code;
+    if (number == 0 || number > 127)
+      return invalid_field(parser, type, field);
+    const size_t block = number >> 3;
+    if (length < block + 1) {
+      memset(wire + length, 0, (block + 1) - length);
+      length = block + 1;
+    }
+    wire[block] |= (uint8_t)(0x80 >> (number & 0x7));
+    lex(parser, token);
+  }
+
+  parser->rdata.length += length;
+  return 0;
+}
+
+#endif // NSEC_H
@@ -0,0 +1,217 @@
+/*
+ * number.h -- parse decimal numbers and mnemonics
+ *
+ * Copyright (c) 2023, NLnet Labs. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#ifndef NUMBER_H
+#define NUMBER_H
+
+#include <assert.h>
+#include <string.h>
+
+#if _WIN32
+#define strncasecmp(s1, s2, n) _strnicmp(s1, s2, n)
+#else
+#include <strings.h>
+#endif
+
+// decimal number without sign, returns the number of digits. at most 19
+// digits are accepted so that numbers cannot overflow
+zone_nonnull_all()
+static zone_inline size_t scan_number(const char *data, uint64_t *number)
+{
+  uint64_t digit, value = 0;
+  size_t length = 0;
+
+  while ((digit = (uint8_t)(data[length] - '0')) <= 9 && length < 19) {
+    value = value * 10 + digit;
+    length++;
+  }
+
+  *number = value;
+  return length;
+}
+
+// number of leading digits in eight octets loaded in little-endian order
+static zone_inline size_t count_digits(uint64_t input)
+{
+  // high nibble must be 3 and low nibble must not exceed 9
+  const uint64_t high = (input & 0xf0f0f0f0f0f0f0f0llu) ^ 0x3030303030303030llu;
+  const uint64_t low = ((input & 0x0f0f0f0f0f0f0f0fllu) + 0x0606060606060606llu) &
+                       0xf0f0f0f0f0f0f0f0llu;
+  // bit 4 is set in each octet that is not a digit
+  const uint64_t other = (((high | low) >> 4) + 0x0f0f0f0f0f0f0f0fllu) &
+                         0x1010101010101010llu;
+  return other ? (size_t)(trailing_zeroes(other) >> 3) : 8;
+}
+
+// convert 1 to 8 leading digits in eight octets loaded in little-endian
+// order, shifting out trailing octets leaves leading zeroes
+static zone_inline uint64_t parse_digits(uint64_t input, size_t length)
+{
+  assert(length >= 1 && length <= 8);
+  input <<= 8 * (8 - length);
+  input = ((input & 0x0f0f0f0f0f0f0f0fllu) * 2561) >> 8;
+  input = ((input & 0x00ff00ff00ff00ffllu) * 6553601) >> 16;
+  return ((input & 0x0000ffff0000ffffllu) * 42949672960001llu) >> 32;
+}
+
+zone_nonnull_all()
+static zone_no_inline int32_t invalid_field(
+  zone_parser_t *parser, const type_info_t *type, const field_info_t *field)
+{
+  SYNTAX_ERROR(parser, "Invalid %.*s in %.*s", NAME(field), NAME(type));
+}
+
+zone_nonnull_all()
+static zone_inline int32_t scan_int(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  const token_t *token,
+  uint64_t maximum,
+  uint64_t *number)
+{
+  int32_t code;
+  size_t length;
+
+  if ((code = have_contiguous(parser, type, field, token)) < 0)
+    return code;
+  length = scan_number(token->data, number);
+  if (zone_unlikely(!length || is_contiguous(token->data + length) || *number > maximum))
+    return invalid_field(parser, type, field);
+  return 0;
+}
+
+zone_nonnull_all()
+static zone_inline void write_int16(uint8_t *octets, uint16_t number)
+{
+  octets[0] = (uint8_t)(number >> 8);
+  octets[1] = (uint8_t)(number);
+}
+
+zone_nonnull_all()
+static zone_inline void write_int32(uint8_t *octets, uint32_t number)
+{
+  octets[0] = (uint8_t)(number >> 24);
+  octets[1] = (uint8_t)(number >> 16);
+  octets[2] = (uint8_t)(number >> 8);
+  octets[3] = (uint8_t)(number);
+}
+
+zone_nonnull_all()
+static zone_inline int32_t parse_int8(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  int32_t code;
+  uint64_t number = 0;
+
+  if ((code = scan_int(parser, type, field, token, UINT8_MAX, &number)) < 0)
+    return code;
+  parser->rdata.octets[parser->rdata.length] = (uint8_t)number;
+  parser->rdata.length += 1;
+  return 0;
+}
+
+zone_nonnull_all()
+static zone_inline int32_t parse_int16(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  int32_t code;
+  uint64_t number = 0;
+
+  if ((code = scan_int(parser, type, field, token, UINT16_MAX, &number)) < 0)
+    return code;
+  write_int16(parser->rdata.octets + parser->rdata.length, (uint16_t)number);
+  parser->rdata.length += 2;
+  return 0;
+}
+
+zone_nonnull_all()
+static zone_inline int32_t parse_int32(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  int32_t code;
+  uint64_t number = 0;
+
+  if ((code = scan_int(parser, type, field, token, UINT32_MAX, &number)) < 0)
+    return code;
+  write_int32(parser->rdata.octets + parser->rdata.length, (uint32_t)number);
+  parser->rdata.length += 4;
+  return 0;
+}
+
+// numeric value or mnemonic, e.g. algorithm (RFC 4034 appendix A.1)
+zone_nonnull_all()
+static zone_inline int32_t scan_symbol(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  const token_t *token,
+  uint64_t maximum,
+  uint64_t *number)
+{
+  if (token->code != CONTIGUOUS || (uint8_t)(token->data[0] - '0') <= 9)
+    return scan_int(parser, type, field, token, maximum, number);
+
+  const size_t length = token_length(token);
+  for (size_t i=0; i < field->symbols.length; i++) {
+    const symbol_t *symbol = &field->symbols.symbols[i];
+    if (symbol->name.length == length &&
+        strncasecmp(symbol->name.data, token->data, length) == 0)
+    {
+      *number = symbol->value;
+      return 0;
+    }
+  }
+
+  return invalid_field(parser, type, field);
+}
+
+zone_nonnull_all()
+static zone_inline int32_t parse_symbol8(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  int32_t code;
+  uint64_t number = 0;
+
+  if ((code = scan_symbol(parser, type, field, token, UINT8_MAX, &number)) < 0)
+    return code;
+  parser->rdata.octets[parser->rdata.length] = (uint8_t)number;
+  parser->rdata.length += 1;
+  return 0;
+}
+
+zone_nonnull_all()
+static zone_inline int32_t parse_symbol16(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  int32_t code;
+  uint64_t number = 0;
+
+  if ((code = scan_symbol(parser, type, field, token, UINT16_MAX, &number)) < 0)
+    return code;
+  write_int16(parser->rdata.octets + parser->rdata.length, (uint16_t)number);
+  parser->rdata.length += 2;
+  return 0;
+}
+
+#endif // NUMBER_H
@@ -1,5 +1,5 @@
 /*
- * parser.h -- some useful comment
+ * parser.h -- parse records and directives
  *
  * Copyright (c) 2022-2023, NLnet Labs. All rights reserved.
  *
@@ -9,147 +9,413 @@
 #ifndef PARSER_H
 #define PARSER_H
 
-static zone_inline zone_return_t parse_rr(
-  zone_parser_t *parser, zone_token_t *token, void *user_data)
+zone_nonnull_all()
+int32_t zone_open_file(
+  zone_parser_t *parser, const zone_string_t *path, zone_file_t **fileptr);
+
+static const field_info_t rr_fields[] = {
+  CANONICAL_FIELD("owner", FIELD_NAME),
+  FIELD("ttl", FIELD_INT32),
+  FIELD("class", FIELD_INT16),
+  FIELD("type", FIELD_INT16)
+};
+
+static const type_info_t rr_type = TYPE_INFO("RR", 0, 0, rr_fields, 0);
+
+zone_nonnull_all()
+static zone_inline bool is_ttl(const token_t *token)
+{
+  // type and class mnemonics cannot start with a digit
+  return token->code == CONTIGUOUS && (uint8_t)(token->data[0] - '0') <= 9;
+}
+
+// <owner> [<TTL>] [<class>] <type> <RDATA> or
+// <owner> [<class>] [<TTL>] <type> <RDATA> (RFC 1035 section 5.1)
+zone_nonnull_all()
+static zone_inline int32_t parse_rr(zone_parser_t *parser, token_t *token)
 {
-  zone_return_t r;
+  int32_t code;
+  uint16_t number = 0;
+  bool have_ttl = false;
+  const type_info_t *type;
 
   if (parser->file->start_of_line) {
-    if ((r = scan_owner(parser, &unknown, &owner, token)) < 0)
-      return r;
+    if ((code = parse_owner(parser, &rr_type, &rr_fields[0], token)) < 0)
+      return code;
     lex(parser, token);
+  } else {
+    parser->same_owner = !parser->reverted_owner;
   }
+  parser->reverted_owner = false;
 
-  if (token->data[0] - '0' <= 9) {
-    if ((r = scan_ttl(parser, &unknown, &ttl, token, &seconds)) < 0)
-      return r;
-    parser->file->last_ttl = seconds;
-    goto class_or_type;
+  if (is_ttl(token)) {
+    if ((code = scan_ttl(parser, &rr_type, &rr_fields[1], token, &parser->file->last_ttl)) < 0)
+      return code;
+    have_ttl = true;
+    lex(parser, token);
   }
 
-  switch ((r = scan_type_or_class(parser, &unknown, &type, token, &code))) {
-    case ZONE_TYPE:
-      parser->file->last_type = code;
-      goto rdata;
-    case ZONE_CLASS:
-      parser->file->last_class = code;
-      goto ttl_or_type;
-    default:
-      assert(r < 0);
-      return r;
+  if ((code = scan_type_or_class(parser, &rr_type, &rr_fields[3], token, &number)) < 0)
+    return code;
+  if (code == CLASS) {
+    parser->file->last_class = number;
+    lex(parser, token);
+    if (!have_ttl && is_ttl(token)) {
+      if ((code = scan_ttl(parser, &rr_type, &rr_fields[1], token, &parser->file->last_ttl)) < 0)
+        return code;
+      have_ttl = true;
+      lex(parser, token);
+    }
+    if ((code = scan_type(parser, &rr_type, &rr_fields[3], token, &number)) < 0)
+      return code;
   }
 
-ttl_or_type:
+  parser->file->last_type = number;
+  if (!have_ttl && parser->file->have_default_ttl)
+    parser->file->last_ttl = parser->file->default_ttl;
+
+  type = type_info(number);
   lex(parser, token);
-  if (token->data[0] - '0' <= 9) {
-    if ((r = scan_ttl(parser, &unknown, &ttl, &seconds)) < 0)
-      return r;
-    parser->file->last_ttl = seconds;
-    goto type;
-  }
 
-  switch ((r = scan_type(parser, &unknown, &ttl, &code))) {
-    case ZONE_TYPE:
-      parser->file->last_type = code;
-      goto rdata;
-    default:
-      assert(r < 0);
-      return r;
+  // generic notation (RFC 3597 section 5)
+  if (zone_unlikely(token->code == CONTIGUOUS &&
+                    token->data[0] == '\\' && token->data[1] == '#' &&
+                    !is_contiguous(token->data + 2)))
+  {
+    if ((code = claim_rdata(parser, 65535, parser->user_data)) < 0)
+      return code;
+    return parse_generic_rdata(parser, type, token);
   }
 
-class_or_type:
-  lex(parser, token)
-  switch ((r = scan_type_or_class(parser, &unknown, &type, token, &code))) {
-    case ZONE_TYPE:
-      parser->file->last_type = code;
-      goto rdata;
-    case ZONE_CLASS:
-      parser->file->last_class = code;
-      goto type;
-    default:
-      assert(r < 0);
-      return r;
-  }
+  if ((code = claim_rdata(parser, type->bound, parser->user_data)) < 0)
+    return code;
+  return type->parse(parser, type, token);
+}
 
-type:
-  lex(parser, token)
-  if ((r = scan_type(parser, &unknown, &type, token, &code)) < 0)
-    return r;
-  parser->file->last_type = code;
+static const field_info_t origin_fields[] = {
+  FIELD("name", FIELD_NAME)
+};
 
-rdata:
-  zone_type_descriptor_t *descriptor = &types[parser->file->last_type];
+static const type_info_t origin_directive =
+  TYPE_INFO("$ORIGIN", 0, 0, origin_fields, 0);
 
-  parser->rdata->length = 0;
+// $ORIGIN <domain-name> [<comment>]
+zone_nonnull_all()
+static zone_inline int32_t parse_dollar_origin(
+  zone_parser_t *parser, token_t *token)
+{
+  int32_t code;
+  zone_name_buffer_t origin;
 
-  // check if RDATA is in generic notation "\#" (RFC3597)
-  if (strncmp(token->data, "\\#", 2) == 0 &&
-      zone_contiguous[ token->data[2] ] != CONTIGUOUS)
-  {
-    if ((r = parse_unknown_rdata(parser, descriptor->info, token)) < 0)
-      return r;
-    return descriptor->check(parser, &descriptor->info);
-  }
+  lex(parser, token);
+  if ((code = have_string(parser, &origin_directive, &origin_fields[0], token)) < 0)
+    return code;
+  // relative names are relative to the current origin
+  if ((code = scan_name(parser, &origin_directive, &origin_fields[0], token,
+                        origin.octets, &origin.length)) < 0)
+    return code;
+  lex(parser, token);
+  if ((code = have_delimiter(parser, &origin_directive, token)) < 0)
+    return code;
 
-  return descriptor->parse(parser, &descriptor->info, token);
+  memcpy(parser->file->origin.octets, origin.octets, origin.length);
+  parser->file->origin.length = origin.length;
+  parser->last_owner.length = 0;
+  return 0;
 }
 
-static zone_inline zone_return_t parse_dollar_origin(
-  zone_parser_t *parser, zone_token_t *token, void *user_data)
+static const field_info_t ttl_fields[] = {
+  FIELD("ttl", FIELD_INT32)
+};
+
+static const type_info_t ttl_directive =
+  TYPE_INFO("$TTL", 0, 0, ttl_fields, 0);
+
+// $TTL <TTL> [<comment>] (RFC 2308 section 4)
+zone_nonnull_all()
+static zone_inline int32_t parse_dollar_ttl(
+  zone_parser_t *parser, token_t *token)
 {
-  // implement
+  int32_t code;
+  uint32_t ttl = 0;
+
+  lex(parser, token);
+  if ((code = scan_ttl(parser, &ttl_directive, &ttl_fields[0], token, &ttl)) < 0)
+    return code;
+  lex(parser, token);
+  if ((code = have_delimiter(parser, &ttl_directive, token)) < 0)
+    return code;
+
+  parser->file->default_ttl = ttl;
+  parser->file->have_default_ttl = true;
+  return 0;
 }
 
-static zone_inline zone_return_t parse_dollar_ttl(
-  zone_parser_t *parser, zone_token_t *token, void *user_data)
+static const field_info_t include_fields[] = {
+  FIELD("file-name", FIELD_STRING),
+  FIELD("domain-name", FIELD_NAME)
+};
+
+static const type_info_t include_directive =
+  TYPE_INFO("$INCLUDE", 0, 0, include_fields, 0);
+
+// $INCLUDE <file-name> [<domain-name>] [<comment>]
+zone_nonnull_all()
+static zone_no_inline int32_t parse_dollar_include(
+  zone_parser_t *parser, token_t *token)
 {
-  // implement
+  int32_t code;
+  size_t length = 0;
+  uint8_t path[4096 + 1 + SIMD_8X_SIZE];
+  zone_file_t *includer = parser->file, *file;
+  zone_name_buffer_t origin;
+
+  if (parser->options.no_includes)
+    NOT_PERMITTED(parser, "%.*s is disabled", NAME(&include_directive));
+
+  lex(parser, token);
+  if ((code = have_string(parser, &include_directive, &include_fields[0], token)) < 0)
+    return code;
+  if ((code = scan_string(parser, &include_directive, &include_fields[0], token,
+                          path, 4096 - 1, &length)) < 0)
+    return code;
+  path[length] = '\0';
+
+  lex(parser, token);
+  if (token->code & STRING) {
+    if ((code = scan_name(parser, &include_directive, &include_fields[1], token,
+                          origin.octets, &origin.length)) < 0)
+      return code;
+    lex(parser, token);
+  } else {
+    origin = includer->origin;
+  }
+
+  // line feed must be consumed before input is read from the included file
+  if ((code = have_delimiter(parser, &include_directive, token)) < 0)
+    return code;
+
+  if ((code = zone_open_file(parser, &(zone_string_t){ length, (const char *)path }, &file)) < 0)
+    RAISE(parser, code, "Cannot open %s", (const char *)path);
+
+  for (zone_file_t *f = includer; f; f = f->includer) {
+    if (strcmp(f->path, file->path) != 0)
+      continue;
+    zone_close_file(parser, file);
+    SEMANTIC_ERROR(parser, "Circular %.*s of %s",
+                   NAME(&include_directive), (const char *)path);
+  }
+
+  file->includer = includer;
+  file->origin = origin;
+  file->last_type = includer->last_type;
+  file->last_class = includer->last_class;
+  file->last_ttl = includer->last_ttl;
+  file->default_ttl = includer->default_ttl;
+  file->have_default_ttl = includer->have_default_ttl;
+  includer->owner.length = parser->owner->length;
+  memcpy(includer->owner.octets, parser->owner->octets, parser->owner->length);
+  parser->file = file;
+  parser->last_owner.length = 0;
+  return 0;
 }
 
-static zone_inline zone_return_t parse_dollar_include(
-  zone_parser_t *parser, zone_token_t *token, void *user_data)
+static const field_info_t generate_fields[] = {
+  FIELD("range", FIELD_STRING),
+  CANONICAL_FIELD("lhs", FIELD_NAME),
+  FIELD("ttl", FIELD_INT32),
+  FIELD("type", FIELD_INT16),
+  FIELD("rhs", FIELD_STRING)
+};
+
+static const type_info_t generate_directive =
+  TYPE_INFO("$GENERATE", 0, 0, generate_fields, 0);
+
+// <start>-<stop>[/<step>]
+zone_nonnull_all()
+static zone_inline int32_t scan_range(
+  zone_parser_t *parser, const token_t *token, uint64_t range[3])
 {
-  // implement
+  const char *data = token->data;
+  size_t count;
+
+  if (token->code != CONTIGUOUS)
+    return unexpected_token(parser, &generate_directive, &generate_fields[0], token);
+  range[2] = 1;
+  if (!(count = scan_number(data, &range[0])) || data[count] != '-')
+    return invalid_field(parser, &generate_directive, &generate_fields[0]);
+  data += count + 1;
+  if (!(count = scan_number(data, &range[1])))
+    return invalid_field(parser, &generate_directive, &generate_fields[0]);
+  data += count;
+  if (*data == '/') {
+    if (!(count = scan_number(++data, &range[2])))
+      return invalid_field(parser, &generate_directive, &generate_fields[0]);
+    data += count;
+  }
+  if (is_contiguous(data) || range[0] > range[1] || range[1] > UINT32_MAX || !range[2])
+    return invalid_field(parser, &generate_directive, &generate_fields[0]);
+  return 0;
 }
 
-static zone_return_t parse_dollar(
-  zone_parser_t *parser, zone_token_t *token, void *user_data)
+// $GENERATE <range> <lhs> [<ttl>] [<class>] <type> <rhs> [<comment>] (BIND 9).
+// templates are expanded once and counters are incremented in place, records
+// are passed to the application without lexing the expanded text. RDATA
+// consisting of a single name or address is supported
+zone_nonnull_all()
+static zone_no_inline int32_t parse_dollar_generate(
+  zone_parser_t *parser, token_t *token)
 {
-  assert(token->code == CONTIGUOUS);
+  int32_t code;
+  uint64_t range[3] = { 0, 0, 0 };
+  uint16_t number = 0;
+  bool have_ttl = false;
+  const type_info_t *type;
+  const field_info_t *field;
+  generate_template_t owner, rdata;
+
+  lex(parser, token);
+  if ((code = scan_range(parser, token, range)) < 0)
+    return code;
+
+  lex(parser, token);
+  if ((code = have_string(parser, &generate_directive, &generate_fields[1], token)) < 0)
+    return code;
+  if (!compile_template(&owner, token, range[0]))
+    return invalid_field(parser, &generate_directive, &generate_fields[1]);
+
+  lex(parser, token);
+  if (is_ttl(token)) {
+    if ((code = scan_ttl(parser, &generate_directive, &generate_fields[2], token, &parser->file->last_ttl)) < 0)
+      return code;
+    have_ttl = true;
+    lex(parser, token);
+  }
+  if ((code = scan_type_or_class(parser, &generate_directive, &generate_fields[3], token, &number)) < 0)
+    return code;
+  if (code == CLASS) {
+    parser->file->last_class = number;
+    lex(parser, token);
+    if (!have_ttl && is_ttl(token)) {
+      if ((code = scan_ttl(parser, &generate_directive, &generate_fields[2], token, &parser->file->last_ttl)) < 0)
+        return code;
+      have_ttl = true;
+      lex(parser, token);
+    }
+    if ((code = scan_type(parser, &generate_directive, &generate_fields[3], token, &number)) < 0)
+      return code;
+  }
 
-  // file buffer is padded with at least ZONE_BLOCK_SIZE bytes
-  if (strncmp(token->data, "$ORIGIN", 7) == 0) {
-    if (zone_contiguous[ token->data[7] ] != CONTIGUOUS)
-      return parse_dollar_origin(parser, token, user_data);
-  } else if (strncmp(token->data, "$TTL", 4) == 0) {
-    if (zone_contiguous[ token->data[4] ] != CONTIGUOUS)
-      return parse_dollar_ttl(parser, token, user_data);
-  } else if (strncmp(token->data, "$ORIGIN", 8) == 0) {
-    if (zone_contiguous[ token->data[8] ] != CONTIGUOUS)
-      return parse_dollar_include(parser, token, user_data);
+  type = type_info(number);
+  field = type->rdata.fields;
+  if (type->rdata.length != 1 || (field->type != FIELD_NAME &&
+                                  field->type != FIELD_IP4 &&
+                                  field->type != FIELD_IP6))
+    NOT_IMPLEMENTED(parser, "%.*s not implemented for %.*s",
+                    NAME(&generate_directive), NAME(type));
+
+  lex(parser, token);
+  if ((code = have_string(parser, &generate_directive, &generate_fields[4], token)) < 0)
+    return code;
+  if (!compile_template(&rdata, token, range[0]))
+    return invalid_field(parser, &generate_directive, &generate_fields[4]);
+
+  lex(parser, token);
+  if ((code = have_delimiter(parser, &generate_directive, token)) < 0)
+    return code;
+
+  parser->file->last_type = number;
+  if (!have_ttl && parser->file->have_default_ttl)
+    parser->file->last_ttl = parser->file->default_ttl;
+
+  parser->same_owner = false;
+  parser->reverted_owner = false;
+  parser->last_owner.length = 0;
+  for (uint64_t iterator = range[0]; ; ) {
+    const token_t lhs = { owner.code, owner.text }, rhs = { rdata.code, rdata.text };
+    zone_name_buffer_t *name = claim_owner(parser);
+    size_t length = 0;
+
+    if ((code = scan_name(parser, &generate_directive, &generate_fields[1], &lhs,
+                          name->octets, &name->length)) < 0)
+      return code;
+    if ((code = claim_rdata(parser, type->bound, parser->user_data)) < 0)
+      return code;
+
+    uint8_t *octets = parser->rdata.octets;
+    if (field->type == FIELD_NAME) {
+      if ((code = scan_name(parser, type, field, &rhs, octets, &length)) < 0)
+        return code;
+    } else if (field->type == FIELD_IP4) {
+      if (!scan_ip4(rdata.text, octets, &length) || rdata.text[length])
+        return invalid_field(parser, type, field);
+      length = 4;
+    } else {
+      if (!scan_ip6(rdata.text, octets, &length) || rdata.text[length])
+        return invalid_field(parser, type, field);
+      length = 16;
+    }
+    parser->rdata.length = length;
+    if ((code = accept_rr(parser, parser->user_data)) < 0)
+      return code;
+
+    if (range[1] - iterator < range[2])
+      break;
+    iterator += range[2];
+    if (!increment_template(&owner, range[2]))
+      return invalid_field(parser, &generate_directive, &generate_fields[1]);
+    if (!increment_template(&rdata, range[2]))
+      return invalid_field(parser, &generate_directive, &generate_fields[4]);
   }
 
-  SYNTAX_ERROR(parser, "Unknown directive")
+  return 0;
 }
 
-static zone_inline zone_return_t parse(
-  zone_parser_t *parser, void *user_data)
+zone_nonnull_all()
+static zone_inline int32_t parse_dollar(zone_parser_t *parser, token_t *token)
 {
-  zone_return_t r;
+  assert(token->code == CONTIGUOUS);
+
+  if (strncasecmp(token->data, "$ORIGIN", 7) == 0 && !is_contiguous(token->data + 7))
+    return parse_dollar_origin(parser, token);
+  if (strncasecmp(token->data, "$TTL", 4) == 0 && !is_contiguous(token->data + 4))
+    return parse_dollar_ttl(parser, token);
+  if (strncasecmp(token->data, "$INCLUDE", 8) == 0 && !is_contiguous(token->data + 8))
+    return parse_dollar_include(parser, token);
+  if (strncasecmp(token->data, "$GENERATE", 9) == 0 && !is_contiguous(token->data + 9))
+    return parse_dollar_generate(parser, token);
+
+  SYNTAX_ERROR(parser, "Unknown directive");
+}
 
-  do {
-    r = lex(parser, &token);
-    if (r == CONTIGUOUS) {
+zone_nonnull_all()
+static int32_t parse_records(zone_parser_t *parser)
+{
+  int32_t code;
+  token_t token;
+
+  // perfect hash tables are filled in by hand, verify them in debug builds
+  assert(check_mnemonics());
+  assert(check_svc_param_keys());
+
+  for (;;) {
+    lex(parser, &token);
+    if (token.code == CONTIGUOUS) {
       if (parser->file->start_of_line && token.data[0] == '$')
-        r = parse_dollar(parser, &token, user_data);
+        code = parse_dollar(parser, &token);
       else
-        r = parse_rr(parser, &token, user_data);
-    } else if (r == QUOTED) {
-      r = parse_rr(parser, &token, user_data);
+        code = parse_rr(parser, &token);
+    } else if (token.code == QUOTED) {
+      code = parse_rr(parser, &token);
+    } else if (token.code == LINE_FEED) {
+      continue;
+    } else {
+      return token.code; // end of file or error
     }
-  } while (r > 0);
 
-  // x. handle errors etc!
+    if (code < 0)
+      return code;
+  }
 }
 
 #endif // PARSER_H
@@ -162,24 +162,35 @@ static int32_t refill(zone_parser_t *parser)
   if (file->buffer.length == file->buffer.size) {
     size_t size = file->buffer.size + ZONE_WINDOW_SIZE;
     char *data = file->buffer.data;
-    if (!(data = realloc(data, size + 1)))
+    if (!(data = zone_realloc(parser, data, size + 1 + ZONE_PADDING_SIZE)))
       OUT_OF_MEMORY(parser);
     file->buffer.size = size;
     file->buffer.data = data;
   }
 
-  size_t count = fread(file->buffer.data + file->buffer.length,
-                       sizeof(file->buffer.data[0]),
-                       file->buffer.size - file->buffer.length,
-                       file->handle);
+  size_t count = file->buffer.size - file->buffer.length;
 
-  if (count == 0 && ferror(file->handle))
-    SYNTAX_ERROR(parser, "actually a read error");
+  if (!file->handle) {
+    // strings are copied too so that kernels can read beyond the input
+    if (count > file->string.length - file->string.index)
+      count = file->string.length - file->string.index;
+    memcpy(file->buffer.data + file->buffer.length,
+           file->string.data + file->string.index, count);
+    file->string.index += count;
+  } else {
+    count = fread(file->buffer.data + file->buffer.length,
+                  sizeof(file->buffer.data[0]), count, file->handle);
+    if (count == 0 && ferror(file->handle))
+      RAISE(parser, ZONE_IO_ERROR, "Cannot read %s", file->name);
+  }
 
   // always null-terminate so terminating token can point to something
-  file->buffer.length += (size_t)count;
+  file->buffer.length += count;
   file->buffer.data[file->buffer.length] = '\0';
-  file->end_of_file = feof(file->handle) != 0;
+  if (!file->handle)
+    file->end_of_file = file->string.index == file->string.length;
+  else
+    file->end_of_file = feof(file->handle) != 0;
   return 0;
 }
 
@@ -239,6 +250,23 @@ static void tokenize(zone_parser_t *parser, const block_t *block)
 zone_nonnull_all()
 void zone_close_file(zone_parser_t *parser, zone_file_t *file);
 
+// owner reverts to the last owner of the includer (RFC 1035 section 5.1)
+zone_nonnull_all()
+static void revert_owner(zone_parser_t *parser)
+{
+  const zone_name_buffer_t *owner = &parser->file->owner;
+
+  if (owner->length == parser->owner->length &&
+      memcmp(owner->octets, parser->owner->octets, owner->length) == 0)
+    return;
+
+  // current owner may be referenced by a pending record
+  zone_name_buffer_t *buffer = claim_owner(parser);
+  memcpy(buffer->octets, owner->octets, owner->length);
+  buffer->length = owner->length;
+  parser->reverted_owner = true;
+}
+
 zone_nonnull_all()
 static zone_no_inline int32_t step(zone_parser_t *parser, token_t *token)
 {
@@ -247,7 +275,8 @@ static zone_no_inline int32_t step(zone_parser_t *parser, token_t *token)
   const char *start, *end;
   bool start_of_line = false;
 
-  // start of line is initially always true
+  // start of line is initially always true. a line feed that terminated the
+  // scanned data could not look ahead, otherwise the lexer already decided
   if (file->indexer.tail == file->indexer.tape)
     start_of_line = true;
   else if (*(end = file->indexer.tail[-1].data) == '\n')
@@ -270,7 +299,9 @@ shuffle:
     file->buffer.length = length;
     file->buffer.data[length] = '\0';
     file->buffer.index = (file->buffer.data + file->buffer.index) - start;
-    refill(parser);
+    int32_t code;
+    if ((code = refill(parser)) < 0)
+      return token->code = code;
   }
 
   start = file->buffer.data + file->buffer.index;
@@ -314,7 +345,8 @@ terminate:
   }
 
   file->indexer.tail[0].data = file->buffer.data + file->buffer.length;
-  file->start_of_line = file->indexer.head[0].data == start && start_of_line;
+  if (start_of_line)
+    file->start_of_line = file->indexer.head[0].data == start;
 
   for (;;) {
     token->data = file->indexer.head[0].data;
@@ -324,14 +356,17 @@ terminate:
         if (file->end_of_file != ZONE_NO_MORE_DATA)
           goto shuffle;
         if (file->grouped)
-          SYNTAX_ERROR(parser, "Missing closing brace");
+          LEX_ERROR(parser, token, "Missing closing brace");
         assert(token->data == file->buffer.data + file->buffer.length);
         if (!file->includer)
           return token->code = END_OF_FILE;
-        parser->file = file = file->includer;
-        parser->owner = &file->owner;
+        // resume includer, terminate last record of included file
+        parser->file = file->includer;
+        parser->last_owner.length = 0;
+        revert_owner(parser);
         zone_close_file(parser, file);
-        break;
+        token->data = line_feed;
+        return token->code = LINE_FEED;
       case '\n':
         if (zone_unlikely(token->data == line_feed))
           file->line += file->indexer.head[0].lines;
@@ -342,17 +377,19 @@ terminate:
         file->start_of_line = classify[ (uint8_t)*(token->data+1) ] != BLANK;
         return token->code = LINE_FEED;
       case '\"':
-        file->indexer.head++;
+        // closing quote is indexed too, tape never contains partial tokens
+        token->data++;
+        file->indexer.head += 2;
         return token->code = QUOTED;
       case '(':
         if (file->grouped)
-          SYNTAX_ERROR(parser, "Nested opening brace");
+          LEX_ERROR(parser, token, "Nested opening brace");
         file->grouped = true;
         file->indexer.head++;
         break;
       case ')':
         if (!file->grouped)
-          SYNTAX_ERROR(parser, "Missing opening brace");
+          LEX_ERROR(parser, token, "Missing opening brace");
         file->grouped = false;
         file->indexer.head++;
         break;
@@ -52,6 +52,13 @@ static zone_inline uint64_t simd_find_8x(const simd_8x_t *simd, char key)
   return (uint32_t)_mm256_movemask_epi8(r);
 }
 
+zone_nonnull_all()
+static zone_inline uint64_t simd_equal_8x(const simd_8x_t *a, const simd_8x_t *b)
+{
+  const __m256i r = _mm256_cmpeq_epi8(a->chunks[0], b->chunks[0]);
+  return (uint32_t)_mm256_movemask_epi8(r);
+}
+
 zone_nonnull_all()
 static zone_inline uint64_t simd_find_any_8x(
   const simd_8x_t *simd, const simd_table_t table)
@@ -77,6 +84,16 @@ static zone_inline uint64_t simd_find_8x16(const simd_8x16_t *simd, char key)
   return m;
 }
 
+zone_nonnull_all()
+static zone_inline uint64_t simd_find_any_8x16(
+  const simd_8x16_t *simd, const simd_table_t table)
+{
+  const __m128i t = _mm_loadu_si128((const __m128i *)table);
+  const __m128i r = _mm_cmpeq_epi8(
+    _mm_shuffle_epi8(t, simd->chunks[0]), simd->chunks[0]);
+  return (uint16_t)_mm_movemask_epi8(r);
+}
+
 zone_nonnull_all()
 static zone_inline void simd_loadu_8x64(simd_8x64_t *simd, const uint8_t *address)
 {
@@ -0,0 +1,570 @@
+/*
+ * svcb.h -- parse service binding parameters (RFC 9460)
+ *
+ * Copyright (c) 2023, NLnet Labs. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#ifndef SVCB_H
+#define SVCB_H
+
+#define SVC_PARAM_MANDATORY (0u)
+#define SVC_PARAM_ALPN (1u)
+#define SVC_PARAM_NO_DEFAULT_ALPN (2u)
+#define SVC_PARAM_PORT (3u)
+#define SVC_PARAM_IPV4HINT (4u)
+#define SVC_PARAM_ECH (5u)
+#define SVC_PARAM_IPV6HINT (6u)
+#define SVC_PARAM_DOHPATH (7u)
+#define SVC_PARAM_OHTTP (8u)
+
+// values are passed as the range of characters between data and end, the
+// value is written at octets and may not extend beyond limit
+typedef int32_t(*svc_param_parse_t)(
+  zone_parser_t *,
+  const type_info_t *,
+  const field_info_t *,
+  const char *,
+  const char *,
+  uint8_t *,
+  const uint8_t *,
+  size_t *);
+
+typedef struct svc_param_info svc_param_info_t;
+struct svc_param_info {
+  char name[16]; // zero padded
+  uint16_t key;
+  svc_param_parse_t parse;
+};
+
+zone_nonnull_all()
+static zone_inline uint16_t read_int16(const uint8_t *octets)
+{
+  return (uint16_t)((octets[0] << 8) | octets[1]);
+}
+
+// decode one character, escape sequences included, returns the number of
+// characters consumed or 0 if the escape sequence is invalid
+zone_nonnull_all()
+static zone_inline size_t scan_svc_octet(const char *data, uint8_t *octet)
+{
+  if (*data != '\\') {
+    *octet = (uint8_t)*data;
+    return 1;
+  }
+  return unescape(data, octet);
+}
+
+// keys with an empty value must be specified without value or with an
+// empty value (RFC 9460 section 2.1)
+zone_nonnull_all()
+static int32_t parse_svc_empty(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  const char *data,
+  const char *end,
+  uint8_t *octets,
+  const uint8_t *limit,
+  size_t *length)
+{
+  (void)octets;
+  (void)limit;
+  if (data != end)
+    return invalid_field(parser, type, field);
+  *length = 0;
+  return 0;
+}
+
+// opaque values, used for dohpath and keys without a known format
+zone_nonnull_all()
+static int32_t parse_svc_opaque(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  const char *data,
+  const char *end,
+  uint8_t *octets,
+  const uint8_t *limit,
+  size_t *length)
+{
+  uint8_t *wire = octets;
+
+  while (data < end) {
+    const size_t count = scan_svc_octet(data, wire);
+    if (!count)
+      return invalid_field(parser, type, field);
+    data += count;
+    if (++wire > limit)
+      return rdata_too_long(parser, type, field);
+  }
+
+  *length = (size_t)(wire - octets);
+  return 0;
+}
+
+zone_nonnull_all()
+static int32_t parse_svc_port(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  const char *data,
+  const char *end,
+  uint8_t *octets,
+  const uint8_t *limit,
+  size_t *length)
+{
+  uint64_t number;
+
+  if (data == end || scan_number(data, &number) != (size_t)(end - data))
+    return invalid_field(parser, type, field);
+  if (number > UINT16_MAX)
+    return invalid_field(parser, type, field);
+  if (octets + 2 > limit)
+    return rdata_too_long(parser, type, field);
+  write_int16(octets, (uint16_t)number);
+  *length = 2;
+  return 0;
+}
+
+// comma separated list of addresses, addresses are converted directly from
+// the input and must be followed by a comma or the end of the value
+zone_nonnull_all()
+static int32_t parse_svc_ipv4hint(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  const char *data,
+  const char *end,
+  uint8_t *octets,
+  const uint8_t *limit,
+  size_t *length)
+{
+  uint8_t *wire = octets;
+
+  for (;;) {
+    size_t count;
+    if (wire + 4 > limit)
+      return rdata_too_long(parser, type, field);
+    if (!scan_ip4(data, wire, &count))
+      return invalid_field(parser, type, field);
+    data += count;
+    wire += 4;
+    if (data == end)
+      break;
+    if (*data != ',')
+      return invalid_field(parser, type, field);
+    data++;
+  }
+
+  *length = (size_t)(wire - octets);
+  return 0;
+}
+
+zone_nonnull_all()
+static int32_t parse_svc_ipv6hint(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  const char *data,
+  const char *end,
+  uint8_t *octets,
+  const uint8_t *limit,
+  size_t *length)
+{
+  uint8_t *wire = octets;
+
+  for (;;) {
+    size_t count;
+    if (wire + 16 > limit)
+      return rdata_too_long(parser, type, field);
+    if (!scan_ip6(data, wire, &count))
+      return invalid_field(parser, type, field);
+    data += count;
+    wire += 16;
+    if (data == end)
+      break;
+    if (*data != ',')
+      return invalid_field(parser, type, field);
+    data++;
+  }
+
+  *length = (size_t)(wire - octets);
+  return 0;
+}
+
+// base64 without whitespace, blocks of 32 digits are decoded at once, the
+// remainder is decoded four digits at a time and may end in padding
+zone_nonnull_all()
+static int32_t parse_svc_ech(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  const char *data,
+  const char *end,
+  uint8_t *octets,
+  const uint8_t *limit,
+  size_t *length)
+{
+  uint8_t *wire = octets;
+
+  if (data == end)
+    return invalid_field(parser, type, field);
+
+  while (end - data >= 32 && wire + 24 <= limit && decode_base64_block(data, wire)) {
+    data += 32;
+    wire += 24;
+  }
+
+  for (; data < end; data += 4) {
+    if (end - data < 4)
+      return invalid_field(parser, type, field);
+    if (wire + 3 > limit)
+      return rdata_too_long(parser, type, field);
+    const uint8_t d0 = base64_table[(uint8_t)data[0]];
+    const uint8_t d1 = base64_table[(uint8_t)data[1]];
+    const uint8_t d2 = base64_table[(uint8_t)data[2]];
+    const uint8_t d3 = base64_table[(uint8_t)data[3]];
+    if ((d0 | d1) == 0xff)
+      return invalid_field(parser, type, field);
+    wire[0] = (uint8_t)((d0 << 2) | (d1 >> 4));
+    if ((d2 | d3) != 0xff) {
+      wire[1] = (uint8_t)((d1 << 4) | (d2 >> 2));
+      wire[2] = (uint8_t)((d2 << 6) | d3);
+      wire += 3;
+      continue;
+    }
+    // padding is only allowed in the last group
+    if (end - data != 4 || data[3] != '=')
+      return invalid_field(parser, type, field);
+    if (d2 != 0xff) {
+      wire[1] = (uint8_t)((d1 << 4) | (d2 >> 2));
+      wire += 2;
+    } else if (data[2] == '=') {
+      wire += 1;
+    } else {
+      return invalid_field(parser, type, field);
+    }
+  }
+
+  *length = (size_t)(wire - octets);
+  return 0;
+}
+
+// value-list (RFC 9460 appendix A.1), items are separated by unescaped
+// commas. escaping is applied twice, once for the character-string and once
+// for the list, a comma is therefore part of an item if written as "\\,"
+zone_nonnull_all()
+static int32_t parse_svc_alpn(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  const char *data,
+  const char *end,
+  uint8_t *octets,
+  const uint8_t *limit,
+  size_t *length)
+{
+  uint8_t *wire = octets;
+
+  for (;;) {
+    uint8_t *item = wire++;
+    bool separator = false;
+    while (data < end) {
+      uint8_t octet;
+      size_t count;
+      if (!(count = scan_svc_octet(data, &octet)))
+        return invalid_field(parser, type, field);
+      data += count;
+      if ((separator = octet == ','))
+        break;
+      if (octet == '\\') {
+        if (data == end || !(count = scan_svc_octet(data, &octet)))
+          return invalid_field(parser, type, field);
+        data += count;
+      }
+      *wire++ = octet;
+      if (wire > limit)
+        return rdata_too_long(parser, type, field);
+    }
+    // items may not be empty, neither may the list
+    const size_t count = (size_t)(wire - item) - 1;
+    if (!count || count > 255)
+      return invalid_field(parser, type, field);
+    *item = (uint8_t)count;
+    if (!separator)
+      break;
+  }
+
+  *length = (size_t)(wire - octets);
+  return 0;
+}
+
+static int32_t parse_svc_mandatory(
+  zone_parser_t *, const type_info_t *, const field_info_t *,
+  const char *, const char *, uint8_t *, const uint8_t *, size_t *);
+
+// registered keys at hash_mnemonic(key), see check_svc_param_keys. a new
+// key may require a different magic value
+#define SVC_PARAM_MAGIC (0xd95bafc8f2a4d27bllu)
+#define SVC_PARAM_BITS (4)
+
+static const svc_param_info_t svc_params[16] = {
+  [0] = { "ipv6hint", SVC_PARAM_IPV6HINT, parse_svc_ipv6hint },
+  [1] = { "dohpath", SVC_PARAM_DOHPATH, parse_svc_opaque },
+  [2] = { "port", SVC_PARAM_PORT, parse_svc_port },
+  [4] = { "alpn", SVC_PARAM_ALPN, parse_svc_alpn },
+  [5] = { "ohttp", SVC_PARAM_OHTTP, parse_svc_empty },
+  [6] = { "mandatory", SVC_PARAM_MANDATORY, parse_svc_mandatory },
+  [7] = { "ipv4hint", SVC_PARAM_IPV4HINT, parse_svc_ipv4hint },
+  [8] = { "no-default-alpn", SVC_PARAM_NO_DEFAULT_ALPN, parse_svc_empty },
+  [9] = { "ech", SVC_PARAM_ECH, parse_svc_ech }
+};
+
+// slots of registered keys by number, for keys written as keyNNNNN
+static const uint8_t svc_param_slots[9] = { 6, 4, 8, 2, 7, 9, 0, 1, 5 };
+
+static const svc_param_info_t svc_param_opaque =
+  { "", 0, parse_svc_opaque };
+
+// keys are lower case (RFC 9460 section 2.1), the compare is exact. keys
+// end at a delimiter or separator, the length is returned in length
+zone_nonnull_all()
+static zone_inline const svc_param_info_t *scan_svc_param_key(
+  const char *data, char separator, size_t *length, uint16_t *key)
+{
+  uint64_t input[2], name[2], number;
+  const svc_param_info_t *param;
+
+  if (!load_mnemonic(data, separator, input, length) || !*length)
+    return NULL;
+
+  param = &svc_params[hash_mnemonic(input, SVC_PARAM_MAGIC, SVC_PARAM_BITS)];
+  memcpy(name, param->name, 16);
+  if (input[0] == name[0] && input[1] == name[1]) {
+    *key = param->key;
+    return param;
+  }
+
+  // keyNNNNN, leading zeroes are not allowed and key65535 is reserved
+  if (*length < 4 || memcmp(data, "key", 3) != 0)
+    return NULL;
+  if (scan_number(data + 3, &number) != *length - 3 || number >= UINT16_MAX)
+    return NULL;
+  if (data[3] == '0' && *length > 4)
+    return NULL;
+  *key = (uint16_t)number;
+  if (number < sizeof(svc_param_slots))
+    return &svc_params[svc_param_slots[number]];
+  return &svc_param_opaque;
+}
+
+// every registered key must be found at the slot it was placed in
+static zone_inline bool check_svc_param_keys(void)
+{
+  for (size_t i=0; i < sizeof(svc_params)/sizeof(svc_params[0]); i++) {
+    size_t length;
+    uint16_t key;
+    if (svc_params[i].name[0] &&
+        scan_svc_param_key(svc_params[i].name, '\0', &length, &key) != &svc_params[i])
+      return false;
+  }
+  return true;
+}
+
+// comma separated list of keys, stored in ascending order. keys may not be
+// listed twice and mandatory may not be listed (RFC 9460 section 8)
+zone_nonnull_all()
+static int32_t parse_svc_mandatory(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  const char *data,
+  const char *end,
+  uint8_t *octets,
+  const uint8_t *limit,
+  size_t *length)
+{
+  uint8_t *wire = octets;
+
+  for (;;) {
+    uint8_t *octet = wire;
+    size_t count;
+    uint16_t key;
+
+    if (!scan_svc_param_key(data, ',', &count, &key))
+      return invalid_field(parser, type, field);
+    data += count;
+    if (data != end && *data != ',')
+      return invalid_field(parser, type, field);
+    if (key == SVC_PARAM_MANDATORY)
+      return invalid_field(parser, type, field);
+    if (wire + 2 > limit)
+      return rdata_too_long(parser, type, field);
+
+    for (; octet > octets; octet -= 2) {
+      const uint16_t previous = read_int16(octet - 2);
+      if (previous == key)
+        return invalid_field(parser, type, field);
+      if (previous < key)
+        break;
+      memcpy(octet, octet - 2, 2);
+    }
+    write_int16(octet, key);
+    wire += 2;
+
+    if (data == end)
+      break;
+    data++;
+  }
+
+  *length = (size_t)(wire - octets);
+  return 0;
+}
+
+zone_nonnull_all()
+static zone_inline void reverse_octets(uint8_t *first, uint8_t *last)
+{
+  for (; first < --last; first++) {
+    const uint8_t octet = *first;
+    *first = *last;
+    *last = octet;
+  }
+}
+
+// parameters must be in ascending order on the wire (RFC 9460 section 2.2),
+// but may appear in any order in presentation format. parameters are parsed
+// in place, out of order parameters are moved to their position by rotating
+// the octets
+zone_nonnull_all()
+static zone_inline int32_t insert_svc_param(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  uint8_t *params,
+  uint8_t *param,
+  uint8_t *end)
+{
+  const uint16_t key = read_int16(param);
+
+  for (uint8_t *octets = params; octets < param; ) {
+    const uint16_t other = read_int16(octets);
+    if (other == key)
+      return invalid_field(parser, type, field);
+    if (other > key) {
+      reverse_octets(octets, param);
+      reverse_octets(param, end);
+      reverse_octets(octets, end);
+      return 0;
+    }
+    octets += 4 + read_int16(octets + 2);
+  }
+
+  return 0;
+}
+
+// keys listed as mandatory must be present and no-default-alpn requires alpn
+// (RFC 9460 section 7.1.1 and section 8). the mandatory key sorts first
+zone_nonnull_all()
+static zone_inline int32_t check_svc_params(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  const uint8_t *params,
+  const uint8_t *end)
+{
+  const uint8_t *octets = params;
+  bool alpn = false, no_default_alpn = false;
+
+  if (params < end && read_int16(params) == SVC_PARAM_MANDATORY) {
+    const uint8_t *keys = params + 4;
+    const uint8_t *last = keys + read_int16(params + 2);
+    octets = last;
+    for (const uint8_t *param = last; keys < last; keys += 2) {
+      const uint16_t key = read_int16(keys);
+      while (param < end && read_int16(param) < key)
+        param += 4 + read_int16(param + 2);
+      if (param == end || read_int16(param) != key)
+        return invalid_field(parser, type, field);
+    }
+  }
+
+  for (; octets < end; octets += 4 + read_int16(octets + 2)) {
+    const uint16_t key = read_int16(octets);
+    if (key > SVC_PARAM_NO_DEFAULT_ALPN)
+      break;
+    alpn |= key == SVC_PARAM_ALPN;
+    no_default_alpn |= key == SVC_PARAM_NO_DEFAULT_ALPN;
+  }
+
+  if (no_default_alpn && !alpn)
+    return invalid_field(parser, type, field);
+  return 0;
+}
+
+// service parameters that make up the remainder of the RDATA, the list may
+// be empty (AliasMode). parameters are written as key=value, values may be
+// quoted. consumes all tokens, token is the delimiter on return
+zone_nonnull_all()
+static zone_inline int32_t parse_svc_params(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  int32_t code;
+  uint8_t *params = parser->rdata.octets + parser->rdata.length;
+  uint8_t *wire = params;
+  const uint8_t *limit = parser->rdata.octets + 65535;
+  int32_t last = -1;
+
+  while (token->code == CONTIGUOUS) {
+    const svc_param_info_t *param;
+    const char *data = token->data, *end;
+    size_t length, count = 0;
+    uint16_t key;
+
+    if (!(param = scan_svc_param_key(data, '=', &length, &key)))
+      return invalid_field(parser, type, field);
+
+    if (data[length] != '=') {
+      data = end = data + length;
+    } else if (data[length + 1] == '"') {
+      lex(parser, token);
+      assert(token->code == QUOTED);
+      data = token->data;
+      end = data + token_length(token);
+    } else {
+      end = data + token_length(token);
+      data += length + 1;
+    }
+
+    if (wire + 4 > limit)
+      return rdata_too_long(parser, type, field);
+    if ((code = param->parse(parser, type, field, data, end, wire + 4, limit, &count)) < 0)
+      return code;
+    // value parsers check the limit themselves, verify regardless so that a
+    // parser that does not can never wrap the RDATA length
+    if (wire + 4 + count > limit)
+      return rdata_too_long(parser, type, field);
+    write_int16(wire, key);
+    write_int16(wire + 2, (uint16_t)count);
+
+    if ((int32_t)key > last) {
+      last = key;
+    } else if ((code = insert_svc_param(parser, type, field, params, wire, wire + 4 + count)) < 0) {
+      return code;
+    }
+
+    wire += 4 + count;
+    lex(parser, token);
+  }
+
+  if ((code = check_svc_params(parser, type, field, params, wire)) < 0)
+    return code;
+  parser->rdata.length = (size_t)(wire - parser->rdata.octets);
+  return 0;
+}
+
+#endif // SVCB_H
@@ -0,0 +1,155 @@
+/*
+ * text.h -- parse character-strings
+ *
+ * Copyright (c) 2023, NLnet Labs. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#ifndef TEXT_H
+#define TEXT_H
+
+// contiguous or quoted (RFC 1035 section 5.1). runs of characters without
+// escape sequences are copied SIMD_8X_SIZE octets at a time, the scalar path
+// only decodes escape sequences. at most limit octets are written, plus
+// SIMD_8X_SIZE octets of overrun that must be covered by padding
+zone_nonnull_all()
+static zone_inline int32_t scan_string(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  const token_t *token,
+  uint8_t *octets,
+  size_t limit,
+  size_t *length)
+{
+  const char *data = token->data;
+  uint8_t *wire = octets;
+  const uint8_t *end = octets + limit;
+  const delimiter_table_t *table =
+    &delimiters[token->code == QUOTED ? QUOTED : CONTIGUOUS];
+  simd_8x_t input;
+
+  for (;;) {
+    simd_loadu_8x(&input, data);
+    simd_storeu_8x(wire, &input);
+    const uint64_t mask = simd_find_8x(&input, '\\') |
+                          simd_find_any_8x(&input, table->special) |
+                          simd_find_any_8x(&input, table->blank);
+    if (!mask) {
+      data += SIMD_8X_SIZE;
+      wire += SIMD_8X_SIZE;
+    } else {
+      size_t count = (size_t)trailing_zeroes(mask);
+      data += count;
+      wire += count;
+      if (*data != '\\')
+        break;
+      if (!(count = unescape(data, wire)))
+        return invalid_field(parser, type, field);
+      data += count;
+      wire++;
+    }
+    if (wire > end)
+      return invalid_field(parser, type, field);
+  }
+
+  if (wire > end)
+    return invalid_field(parser, type, field);
+  // unterminated quoted string at end of input
+  if (token->code == QUOTED && *data != '\"')
+    return invalid_field(parser, type, field);
+
+  *length = (size_t)(wire - octets);
+  return 0;
+}
+
+zone_nonnull_all()
+static zone_inline int32_t parse_string(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  int32_t code;
+  size_t length = 0;
+  uint8_t *octets = parser->rdata.octets + parser->rdata.length;
+
+  if ((code = have_string(parser, type, field, token)) < 0)
+    return code;
+  if ((code = scan_string(parser, type, field, token, octets + 1, 255, &length)) < 0)
+    return code;
+  octets[0] = (uint8_t)length;
+  parser->rdata.length += 1 + length;
+  return 0;
+}
+
+// string without length octet that makes up the remainder of the RDATA,
+// e.g. CAA value (RFC 8659 section 4.1.1)
+zone_nonnull_all()
+static zone_inline int32_t parse_text(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  int32_t code;
+  size_t length = 0;
+  const size_t limit = 65535 - parser->rdata.length;
+
+  if ((code = have_string(parser, type, field, token)) < 0)
+    return code;
+  if ((code = scan_string(parser, type, field, token,
+                          parser->rdata.octets + parser->rdata.length,
+                          limit, &length)) < 0)
+    return code;
+  parser->rdata.length += length;
+  return 0;
+}
+
+// one or more strings that make up the remainder of the RDATA, e.g. TXT.
+// strings of more than 255 octets are split into consecutive strings by
+// moving the tail segments back to make room for their length octets.
+// consumes all strings, token is the delimiter on return
+zone_nonnull_all()
+static zone_inline int32_t parse_strings(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  int32_t code;
+
+  if ((code = have_string(parser, type, field, token)) < 0)
+    return code;
+
+  do {
+    size_t length = 0;
+    uint8_t *octets = parser->rdata.octets + parser->rdata.length;
+    if (parser->rdata.length >= 65535)
+      return rdata_too_long(parser, type, field);
+    const size_t limit = 65535 - (parser->rdata.length + 1);
+    if ((code = scan_string(parser, type, field, token, octets + 1, limit, &length)) < 0)
+      return code;
+    if (zone_unlikely(length > 255)) {
+      const size_t count = (length + 254) / 255;
+      if (length + count > limit + 1)
+        return rdata_too_long(parser, type, field);
+      for (size_t i = count - 1; i > 0; i--) {
+        const size_t segment = length - i * 255 < 255 ? length - i * 255 : 255;
+        memmove(octets + i * 256 + 1, octets + i * 255 + 1, segment);
+        octets[i * 256] = (uint8_t)segment;
+      }
+      octets[0] = 255;
+      parser->rdata.length += count + length;
+    } else {
+      octets[0] = (uint8_t)length;
+      parser->rdata.length += 1 + length;
+    }
+    lex(parser, token);
+  } while (token->code & STRING);
+
+  return 0;
+}
+
+#endif // TEXT_H
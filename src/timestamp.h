@@ -0,0 +1,95 @@
+/*
+ * timestamp.h -- parse RRSIG expiration and inception fields
+ *
+ * Copyright (c) 2023, NLnet Labs. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#ifndef TIMESTAMP_H
+#define TIMESTAMP_H
+
+// days since 1970-01-01, see http://howardhinnant.github.io/date_algorithms.html.
+// years before 1970 are rejected by the caller, which keeps the era
+// calculation unsigned and free of branches
+static zone_inline uint64_t days_from_civil(uint64_t y, uint64_t m, uint64_t d)
+{
+  y -= m <= 2;
+  const uint64_t era = y / 400;
+  const uint64_t yoe = y - era * 400; // [0, 399]
+  const uint64_t doy = (153 * ((m + 9) % 12) + 2) / 5 + d - 1; // [0, 365]
+  const uint64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy; // [0, 146096]
+  return era * 146097 + doe - 719468;
+}
+
+// convert eight digits to four two-digit numbers in the even octets
+static zone_inline uint64_t parse_pairs(uint64_t input)
+{
+  return ((input & 0x0f0f0f0f0f0f0f0fllu) * 2561) >> 8;
+}
+
+// YYYYMMDDHHmmSS (RFC 4034 section 3.2), loaded as YYYYMMDD and DDHHmmSS so
+// that both loads are eight digits
+zone_nonnull_all()
+static zone_inline bool scan_timestamp(const char *data, uint64_t *seconds)
+{
+  static const uint8_t days_per_month[16] =
+    { 0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31, 0, 0, 0 };
+  uint64_t date, time;
+
+  memcpy(&date, data, 8);
+  memcpy(&time, data + 6, 8);
+  if ((count_digits(date) & count_digits(time)) != 8)
+    return false;
+
+  date = parse_pairs(date);
+  time = parse_pairs(time);
+  const uint64_t year = (date & 0xff) * 100 + ((date >> 16) & 0xff);
+  const uint64_t month = (date >> 32) & 0xff;
+  const uint64_t day = (date >> 48) & 0xff;
+  const uint64_t hours = (time >> 16) & 0xff;
+  const uint64_t minutes = (time >> 32) & 0xff;
+  const uint64_t secs = (time >> 48) & 0xff;
+  const uint64_t leap =
+    (year % 4 == 0) & ((year % 100 != 0) | (year % 400 == 0)) & (month == 2);
+
+  if ((year < 1970) | (month - 1 > 11) | (day - 1 >= days_per_month[month & 0xf] + leap) |
+      (hours > 23) | (minutes > 59) | (secs > 59))
+    return false;
+
+  *seconds = days_from_civil(year, month, day) * 86400 +
+             hours * 3600 + minutes * 60 + secs;
+  return true;
+}
+
+zone_nonnull_all()
+static zone_inline int32_t parse_time(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  int32_t code;
+  uint64_t number;
+  size_t length;
+
+  if ((code = have_contiguous(parser, type, field, token)) < 0)
+    return code;
+
+  if (!is_contiguous(token->data + 14) && scan_timestamp(token->data, &number)) {
+    // serial number arithmetic applies (RFC 4034 section 3.1.5)
+    number &= UINT32_MAX;
+  } else {
+    length = scan_number(token->data, &number);
+    if (!length || length == 14 || is_contiguous(token->data + length))
+      return invalid_field(parser, type, field);
+    if (number > UINT32_MAX)
+      return invalid_field(parser, type, field);
+  }
+
+  write_int32(parser->rdata.octets + parser->rdata.length, (uint32_t)number);
+  parser->rdata.length += 4;
+  return 0;
+}
+
+#endif // TIMESTAMP_H
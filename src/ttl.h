@@ -0,0 +1,156 @@
+/*
+ * ttl.h -- parse time-to-live (TTL) fields
+ *
+ * Copyright (c) 2023, NLnet Labs. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#ifndef TTL_H
+#define TTL_H
+
+// RFC 2181 section 8 specifies TTLs are unsigned values between 0 and
+// 2147483647 (2^31 - 1) seconds
+#define MAX_TTL ((uint64_t)INT32_MAX)
+
+// units in 1w2d3h4m5s notation, matched after folding to lower case
+static const simd_table_t ttl_units = SIMD_TABLE(
+  0x01, // 0x00
+  0x00, // 0x01
+  0x00, // 0x02
+  0x73, // 0x03 : "s" : 0x73 -- seconds
+  0x64, // 0x04 : "d" : 0x64 -- days
+  0x00, // 0x05
+  0x00, // 0x06
+  0x77, // 0x07 : "w" : 0x77 -- weeks
+  0x68, // 0x08 : "h" : 0x68 -- hours
+  0x00, // 0x09
+  0x00, // 0x0a
+  0x00, // 0x0b
+  0x00, // 0x0c
+  0x6d, // 0x0d : "m" : 0x6d -- minutes
+  0x00, // 0x0e
+  0x00  // 0x0f
+);
+
+// 1w2d3h4m5s notation, units are case insensitive and must be specified in
+// descending order. the token is classified in one go, which limits the
+// notation to SIMD_8X_SIZE characters
+zone_nonnull_all()
+static zone_no_inline int32_t scan_friendly_ttl(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  const token_t *token,
+  uint32_t *seconds)
+{
+  uint64_t words[SIMD_8X_SIZE / 8], units, number, total = 0, previous = UINT64_MAX;
+  const size_t length = token_length(token);
+  size_t start = 0;
+  simd_8x_t input;
+
+  if (length > SIMD_8X_SIZE)
+    return invalid_field(parser, type, field);
+
+  memcpy(words, token->data, sizeof(words));
+  for (size_t i=0; i < sizeof(words) / 8; i++)
+    words[i] |= 0x2020202020202020llu;
+  simd_loadu_8x(&input, words);
+  units = simd_find_any_8x(&input, ttl_units);
+  units &= (1llu << length) - 1;
+
+  for (; units; units = clear_lowest_bit(units)) {
+    const size_t end = (size_t)trailing_zeroes(units);
+    uint64_t unit;
+    if (scan_number(token->data + start, &number) != end - start || start == end)
+      return invalid_field(parser, type, field);
+    switch (token->data[end] | 0x20) {
+      case 'w': unit = 604800; break;
+      case 'd': unit = 86400; break;
+      case 'h': unit = 3600; break;
+      case 'm': unit = 60; break;
+      default:  unit = 1; break;
+    }
+
+    if (unit >= previous || number > MAX_TTL)
+      return invalid_field(parser, type, field);
+    total += number * unit;
+    if (total > MAX_TTL)
+      return invalid_field(parser, type, field);
+    previous = unit;
+    start = end + 1;
+  }
+
+  // every number must be followed by a unit
+  if (!start || start != length)
+    return invalid_field(parser, type, field);
+  *seconds = (uint32_t)total;
+  return 0;
+}
+
+// plain TTLs are converted eight digits at a time, numbers of more than
+// ten digits can only be in range with leading zeroes
+zone_nonnull_all()
+static zone_inline int32_t scan_ttl(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  const token_t *token,
+  uint32_t *seconds)
+{
+  int32_t code;
+  uint64_t input, number = 0;
+  size_t length;
+
+  if ((code = have_contiguous(parser, type, field, token)) < 0)
+    return code;
+
+  memcpy(&input, token->data, 8);
+  length = count_digits(input);
+  if (length && length < 8) {
+    number = parse_digits(input, length);
+  } else if (length == 8) {
+    uint64_t next;
+    memcpy(&next, token->data + 8, 8);
+    const size_t count = count_digits(next);
+    if (count > 2) {
+      length = scan_number(token->data, &number);
+    } else {
+      static const uint64_t powers[3] = { 1, 10, 100 };
+      number = parse_digits(input, 8) * powers[count];
+      if (count)
+        number += parse_digits(next, count);
+      length += count;
+    }
+  }
+
+  if (zone_unlikely(is_contiguous(token->data + length))) {
+    if (!parser->options.friendly_ttls)
+      return invalid_field(parser, type, field);
+    return scan_friendly_ttl(parser, type, field, token, seconds);
+  }
+
+  if (zone_unlikely(!length || number > MAX_TTL))
+    return invalid_field(parser, type, field);
+  *seconds = (uint32_t)number;
+  return 0;
+}
+
+zone_nonnull_all()
+static zone_inline int32_t parse_ttl(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  int32_t code;
+  uint32_t seconds = 0;
+
+  if ((code = scan_ttl(parser, type, field, token, &seconds)) < 0)
+    return code;
+  write_int32(parser->rdata.octets + parser->rdata.length, seconds);
+  parser->rdata.length += 4;
+  return 0;
+}
+
+#endif // TTL_H
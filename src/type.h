@@ -0,0 +1,215 @@
+/*
+ * type.h -- parse type and class mnemonics
+ *
+ * Copyright (c) 2023, NLnet Labs. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#ifndef TYPE_H
+#define TYPE_H
+
+#define TYPE (1)
+#define CLASS (2)
+
+typedef struct mnemonic mnemonic_t;
+struct mnemonic {
+  char name[16]; // upper case, zero padded
+  uint16_t code;
+  uint16_t kind;
+};
+
+#define MNEMONIC(name, code, kind) { name, code, kind }
+
+// perfect hash over the case-folded, zero padded mnemonic. entries are placed
+// by hand at hash_mnemonic(name), check_mnemonics verifies the placement. the
+// magic value was found by trying random odd multipliers until no two
+// mnemonics collided, search again if check_mnemonics fails
+#define MNEMONIC_MAGIC (0x56db205740b88047llu)
+#define MNEMONIC_BITS (8)
+
+static const mnemonic_t mnemonics[256] = {
+  [0] = MNEMONIC("ZONEMD", ZONE_ZONEMD, TYPE),
+  [5] = MNEMONIC("HIP", ZONE_HIP, TYPE),
+  [10] = MNEMONIC("MF", ZONE_MF, TYPE),
+  [13] = MNEMONIC("A", ZONE_A, TYPE),
+  [14] = MNEMONIC("AAAA", ZONE_AAAA, TYPE),
+  [15] = MNEMONIC("NSEC", ZONE_NSEC, TYPE),
+  [29] = MNEMONIC("DS", ZONE_DS, TYPE),
+  [33] = MNEMONIC("APL", ZONE_APL, TYPE),
+  [46] = MNEMONIC("NSEC3PARAM", ZONE_NSEC3PARAM, TYPE),
+  [48] = MNEMONIC("HTTPS", ZONE_HTTPS, TYPE),
+  [49] = MNEMONIC("TLSA", ZONE_TLSA, TYPE),
+  [51] = MNEMONIC("WKS", ZONE_WKS, TYPE),
+  [54] = MNEMONIC("SRV", ZONE_SRV, TYPE),
+  [60] = MNEMONIC("DHCID", ZONE_DHCID, TYPE),
+  [63] = MNEMONIC("URI", ZONE_URI, TYPE),
+  [67] = MNEMONIC("LP", ZONE_LP, TYPE),
+  [69] = MNEMONIC("EUI48", ZONE_EUI48, TYPE),
+  [75] = MNEMONIC("MINFO", ZONE_MINFO, TYPE),
+  [76] = MNEMONIC("RP", ZONE_RP, TYPE),
+  [80] = MNEMONIC("MR", ZONE_MR, TYPE),
+  [81] = MNEMONIC("AFSDB", ZONE_AFSDB, TYPE),
+  [83] = MNEMONIC("RRSIG", ZONE_RRSIG, TYPE),
+  [84] = MNEMONIC("MD", ZONE_MD, TYPE),
+  [89] = MNEMONIC("X25", ZONE_X25, TYPE),
+  [92] = MNEMONIC("CH", ZONE_CH, CLASS),
+  [93] = MNEMONIC("CDNSKEY", ZONE_CDNSKEY, TYPE),
+  [98] = MNEMONIC("SSHFP", ZONE_SSHFP, TYPE),
+  [101] = MNEMONIC("CNAME", ZONE_CNAME, TYPE),
+  [102] = MNEMONIC("NXT", ZONE_NXT, TYPE),
+  [103] = MNEMONIC("PTR", ZONE_PTR, TYPE),
+  [108] = MNEMONIC("CDS", ZONE_CDS, TYPE),
+  [111] = MNEMONIC("TXT", ZONE_TXT, TYPE),
+  [115] = MNEMONIC("MX", ZONE_MX, TYPE),
+  [119] = MNEMONIC("PX", ZONE_PX, TYPE),
+  [120] = MNEMONIC("DNSKEY", ZONE_DNSKEY, TYPE),
+  [121] = MNEMONIC("HS", ZONE_HS, CLASS),
+  [123] = MNEMONIC("SPF", ZONE_SPF, TYPE),
+  [127] = MNEMONIC("IPSECKEY", ZONE_IPSECKEY, TYPE),
+  [130] = MNEMONIC("NS", ZONE_NS, TYPE),
+  [136] = MNEMONIC("IN", ZONE_IN, CLASS),
+  [138] = MNEMONIC("NID", ZONE_NID, TYPE),
+  [139] = MNEMONIC("CSYNC", ZONE_CSYNC, TYPE),
+  [145] = MNEMONIC("NAPTR", ZONE_NAPTR, TYPE),
+  [147] = MNEMONIC("L64", ZONE_L64, TYPE),
+  [148] = MNEMONIC("CAA", ZONE_CAA, TYPE),
+  [153] = MNEMONIC("HINFO", ZONE_HINFO, TYPE),
+  [157] = MNEMONIC("SIG", ZONE_SIG, TYPE),
+  [158] = MNEMONIC("MB", ZONE_MB, TYPE),
+  [174] = MNEMONIC("OPENPGPKEY", ZONE_OPENPGPKEY, TYPE),
+  [184] = MNEMONIC("RT", ZONE_RT, TYPE),
+  [185] = MNEMONIC("NULL", ZONE_NULL, TYPE),
+  [187] = MNEMONIC("SVCB", ZONE_SVCB, TYPE),
+  [188] = MNEMONIC("DNAME", ZONE_DNAME, TYPE),
+  [192] = MNEMONIC("KEY", ZONE_KEY, TYPE),
+  [193] = MNEMONIC("L32", ZONE_L32, TYPE),
+  [197] = MNEMONIC("KX", ZONE_KX, TYPE),
+  [198] = MNEMONIC("CS", ZONE_CS, CLASS),
+  [200] = MNEMONIC("CERT", ZONE_CERT, TYPE),
+  [211] = MNEMONIC("SMIMEA", ZONE_SMIMEA, TYPE),
+  [222] = MNEMONIC("LOC", ZONE_LOC, TYPE),
+  [229] = MNEMONIC("MG", ZONE_MG, TYPE),
+  [240] = MNEMONIC("EUI64", ZONE_EUI64, TYPE),
+  [244] = MNEMONIC("NSEC3", ZONE_NSEC3, TYPE),
+  [252] = MNEMONIC("ISDN", ZONE_ISDN, TYPE),
+  [253] = MNEMONIC("DLV", ZONE_DLV, TYPE),
+  [254] = MNEMONIC("SOA", ZONE_SOA, TYPE),
+};
+
+// non-letters never fold into letters or digits, the compare is therefore
+// exact. the length of the mnemonic is found while loading
+zone_nonnull_all()
+static zone_inline const mnemonic_t *find_mnemonic(const char *data)
+{
+  uint64_t input[2], name[2];
+  const uint64_t letters = 0x4040404040404040llu;
+  const mnemonic_t *mnemonic;
+  size_t length;
+
+  if (!load_mnemonic(data, '\0', input, &length))
+    return NULL;
+  input[0] &= ~((input[0] & letters) >> 1);
+  input[1] &= ~((input[1] & letters) >> 1);
+
+  mnemonic = &mnemonics[hash_mnemonic(input, MNEMONIC_MAGIC, MNEMONIC_BITS)];
+  memcpy(name, mnemonic->name, 16);
+  if (input[0] != name[0] || input[1] != name[1])
+    return NULL;
+  return mnemonic;
+}
+
+// every mnemonic must be found at the slot it was placed in
+static zone_inline bool check_mnemonics(void)
+{
+  for (size_t i=0; i < sizeof(mnemonics)/sizeof(mnemonics[0]); i++)
+    if (mnemonics[i].name[0] && find_mnemonic(mnemonics[i].name) != &mnemonics[i])
+      return false;
+  return true;
+}
+
+// TYPEnnn and CLASSnnn (RFC 3597 section 5)
+zone_nonnull_all()
+static zone_inline bool scan_generic(
+  const char *data, const char *prefix, size_t prefix_length, uint16_t *code)
+{
+  uint64_t number;
+  size_t length;
+
+  if (strncasecmp(data, prefix, prefix_length) != 0)
+    return false;
+  data += prefix_length;
+  if (!(length = scan_number(data, &number)) || is_contiguous(data + length))
+    return false;
+  if (number > UINT16_MAX)
+    return false;
+  *code = (uint16_t)number;
+  return true;
+}
+
+zone_nonnull_all()
+static zone_inline int32_t scan_type_or_class(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  const token_t *token,
+  uint16_t *code)
+{
+  const mnemonic_t *mnemonic;
+
+  if (token->code != CONTIGUOUS)
+    return unexpected_token(parser, type, field, token);
+
+  if ((mnemonic = find_mnemonic(token->data))) {
+    *code = mnemonic->code;
+    return mnemonic->kind;
+  }
+  if (scan_generic(token->data, "TYPE", 4, code))
+    return TYPE;
+  if (scan_generic(token->data, "CLASS", 5, code))
+    return CLASS;
+
+  return invalid_field(parser, type, field);
+}
+
+zone_nonnull_all()
+static zone_inline int32_t scan_type(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  const token_t *token,
+  uint16_t *code)
+{
+  const mnemonic_t *mnemonic;
+
+  if (token->code != CONTIGUOUS)
+    return unexpected_token(parser, type, field, token);
+
+  if ((mnemonic = find_mnemonic(token->data)) && mnemonic->kind == TYPE) {
+    *code = mnemonic->code;
+    return TYPE;
+  }
+  if (scan_generic(token->data, "TYPE", 4, code))
+    return TYPE;
+
+  return invalid_field(parser, type, field);
+}
+
+zone_nonnull_all()
+static zone_inline int32_t parse_type(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  int32_t code;
+  uint16_t number = 0;
+
+  if ((code = scan_type(parser, type, field, token, &number)) < 0)
+    return code;
+  write_int16(parser->rdata.octets + parser->rdata.length, number);
+  parser->rdata.length += 2;
+  return 0;
+}
+
+#endif // TYPE_H
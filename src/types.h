@@ -0,0 +1,875 @@
+/*
+ * types.h -- RDATA parsers and type descriptors
+ *
+ * Copyright (c) 2023, NLnet Labs. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+#ifndef TYPES_H
+#define TYPES_H
+
+// parse functions are generated per layout of the RDATA and invoke the field
+// parsers in order so that the compiler generates straight-line code rather
+// than a generic interpreter that loops over the descriptors. types with the
+// same layout share the parse function, the descriptors differ and are used
+// for error reporting and validation
+
+// DNS Security Algorithm Numbers (RFC 4034 appendix A.1)
+static const symbol_t algorithms[] = {
+  SYMBOL("RSAMD5", 1),
+  SYMBOL("DH", 2),
+  SYMBOL("DSA", 3),
+  SYMBOL("RSASHA1", 5),
+  SYMBOL("DSA-NSEC3-SHA1", 6),
+  SYMBOL("RSASHA1-NSEC3-SHA1", 7),
+  SYMBOL("RSASHA256", 8),
+  SYMBOL("RSASHA512", 10),
+  SYMBOL("ECC-GOST", 12),
+  SYMBOL("ECDSAP256SHA256", 13),
+  SYMBOL("ECDSAP384SHA384", 14),
+  SYMBOL("ED25519", 15),
+  SYMBOL("ED448", 16),
+  SYMBOL("INDIRECT", 252),
+  SYMBOL("PRIVATEDNS", 253),
+  SYMBOL("PRIVATEOID", 254)
+};
+
+// certificate types (RFC 4398 section 2.1)
+static const symbol_t certificate_types[] = {
+  SYMBOL("PKIX", 1),
+  SYMBOL("SPKI", 2),
+  SYMBOL("PGP", 3),
+  SYMBOL("IPKIX", 4),
+  SYMBOL("ISPKI", 5),
+  SYMBOL("IPGP", 6),
+  SYMBOL("ACPKIX", 7),
+  SYMBOL("IACPKIX", 8),
+  SYMBOL("URI", 253),
+  SYMBOL("OID", 254)
+};
+
+// protocols in WKS (RFC 1010)
+static const symbol_t protocols[] = {
+  SYMBOL("TCP", 6),
+  SYMBOL("UDP", 17)
+};
+
+// well-known services in WKS (RFC 1010)
+static const symbol_t services[] = {
+  SYMBOL("ftp-data", 20),
+  SYMBOL("ftp", 21),
+  SYMBOL("ssh", 22),
+  SYMBOL("telnet", 23),
+  SYMBOL("smtp", 25),
+  SYMBOL("time", 37),
+  SYMBOL("domain", 53),
+  SYMBOL("tftp", 69),
+  SYMBOL("finger", 79),
+  SYMBOL("http", 80),
+  SYMBOL("kerberos", 88),
+  SYMBOL("pop3", 110),
+  SYMBOL("sunrpc", 111),
+  SYMBOL("nntp", 119),
+  SYMBOL("ntp", 123),
+  SYMBOL("imap", 143),
+  SYMBOL("snmp", 161),
+  SYMBOL("ldap", 389),
+  SYMBOL("https", 443)
+};
+
+// tag consists of alphanumeric characters only (RFC 8659 section 4.1)
+zone_nonnull_all()
+static zone_inline int32_t parse_caa_tag(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  int32_t code;
+  uint8_t *octets = parser->rdata.octets + parser->rdata.length;
+  size_t length = 0;
+
+  if ((code = have_contiguous(parser, type, field, token)) < 0)
+    return code;
+
+  for (const char *data = token->data; is_contiguous(data); data++) {
+    const uint8_t c = (uint8_t)*data;
+    if ((uint8_t)(c - '0') > 9 && (uint8_t)((c | 0x20) - 'a') > 25)
+      return invalid_field(parser, type, field);
+    if (length == 255)
+      return invalid_field(parser, type, field);
+    octets[++length] = c;
+  }
+
+  octets[0] = (uint8_t)length;
+  parser->rdata.length += 1 + length;
+  return 0;
+}
+
+// services that make up the remainder of the RDATA, one bit per port
+// without trailing zero octets (RFC 1035 section 3.4.2). consumes all
+// tokens, token is the delimiter on return
+zone_nonnull_all()
+static zone_inline int32_t parse_wks_services(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  int32_t code;
+  uint8_t *wire = parser->rdata.octets + parser->rdata.length;
+  size_t length = 0;
+
+  while (token->code == CONTIGUOUS) {
+    uint64_t port = 0;
+    if ((code = scan_symbol(parser, type, field, token, UINT16_MAX, &port)) < 0)
+      return code;
+    const size_t block = (size_t)(port >> 3);
+    if (length < block + 1) {
+      memset(wire + length, 0, (block + 1) - length);
+      length = block + 1;
+    }
+    wire[block] |= (uint8_t)(0x80 >> (port & 0x7));
+    lex(parser, token);
+  }
+
+  parser->rdata.length += length;
+  return 0;
+}
+
+// format of the gateway is selected by the gateway type that precedes the
+// algorithm, "." if there is no gateway (RFC 4025 section 2.3)
+zone_nonnull_all()
+static zone_inline int32_t parse_gateway(
+  zone_parser_t *parser,
+  const type_info_t *type,
+  const field_info_t *field,
+  token_t *token)
+{
+  int32_t code;
+
+  switch (parser->rdata.octets[parser->rdata.length - 2]) {
+    case 0:
+      if ((code = have_contiguous(parser, type, field, token)) < 0)
+        return code;
+      if (token->data[0] != '.' || is_contiguous(token->data + 1))
+        return invalid_field(parser, type, field);
+      return 0;
+    case 1:
+      return parse_ip4(parser, type, field, token);
+    case 2:
+      return parse_ip6(parser, type, field, token);
+    case 3:
+      return parse_name(parser, type, field, token);
+    default:
+      return invalid_field(parser, type, field);
+  }
+}
+
+static const field_info_t a_rdata_fields[] = {
+  FIELD("address", FIELD_IP4)
+};
+
+static const field_info_t ns_rdata_fields[] = {
+  CANONICAL_FIELD("host", FIELD_NAME)
+};
+
+static const field_info_t md_rdata_fields[] = {
+  CANONICAL_FIELD("madname", FIELD_NAME)
+};
+
+static const field_info_t mf_rdata_fields[] = {
+  CANONICAL_FIELD("madname", FIELD_NAME)
+};
+
+static const field_info_t cname_rdata_fields[] = {
+  CANONICAL_FIELD("host", FIELD_NAME)
+};
+
+static const field_info_t soa_rdata_fields[] = {
+  CANONICAL_FIELD("primary", FIELD_NAME),
+  CANONICAL_FIELD("mailbox", FIELD_NAME),
+  FIELD("serial", FIELD_INT32),
+  FIELD("refresh", FIELD_INT32),
+  FIELD("retry", FIELD_INT32),
+  FIELD("expire", FIELD_INT32),
+  FIELD("minimum", FIELD_INT32)
+};
+
+static const field_info_t mb_rdata_fields[] = {
+  CANONICAL_FIELD("madname", FIELD_NAME)
+};
+
+static const field_info_t mg_rdata_fields[] = {
+  CANONICAL_FIELD("mgmname", FIELD_NAME)
+};
+
+static const field_info_t mr_rdata_fields[] = {
+  CANONICAL_FIELD("newname", FIELD_NAME)
+};
+
+static const field_info_t wks_rdata_fields[] = {
+  FIELD("address", FIELD_IP4),
+  SYMBOLIC_FIELD("protocol", FIELD_INT8, protocols),
+  SYMBOLIC_FIELD("bitmap", FIELD_BLOB, services)
+};
+
+static const field_info_t ptr_rdata_fields[] = {
+  CANONICAL_FIELD("ptrdname", FIELD_NAME)
+};
+
+static const field_info_t hinfo_rdata_fields[] = {
+  FIELD("cpu", FIELD_STRING),
+  FIELD("os", FIELD_STRING)
+};
+
+static const field_info_t minfo_rdata_fields[] = {
+  CANONICAL_FIELD("rmailbx", FIELD_NAME),
+  CANONICAL_FIELD("emailbx", FIELD_NAME)
+};
+
+static const field_info_t mx_rdata_fields[] = {
+  FIELD("priority", FIELD_INT16),
+  CANONICAL_FIELD("hostname", FIELD_NAME)
+};
+
+static const field_info_t txt_rdata_fields[] = {
+  FIELD("text", FIELD_STRINGS)
+};
+
+static const field_info_t rp_rdata_fields[] = {
+  CANONICAL_FIELD("mailbox", FIELD_NAME),
+  CANONICAL_FIELD("text", FIELD_NAME)
+};
+
+static const field_info_t afsdb_rdata_fields[] = {
+  FIELD("subtype", FIELD_INT16),
+  CANONICAL_FIELD("hostname", FIELD_NAME)
+};
+
+static const field_info_t x25_rdata_fields[] = {
+  FIELD("address", FIELD_STRING)
+};
+
+static const field_info_t isdn_rdata_fields[] = {
+  FIELD("address", FIELD_STRING),
+  OPTIONAL_FIELD("subaddress", FIELD_STRING)
+};
+
+static const field_info_t rt_rdata_fields[] = {
+  FIELD("preference", FIELD_INT16),
+  CANONICAL_FIELD("hostname", FIELD_NAME)
+};
+
+static const field_info_t px_rdata_fields[] = {
+  FIELD("preference", FIELD_INT16),
+  CANONICAL_FIELD("map822", FIELD_NAME),
+  CANONICAL_FIELD("mapx400", FIELD_NAME)
+};
+
+static const field_info_t aaaa_rdata_fields[] = {
+  FIELD("address", FIELD_IP6)
+};
+
+static const field_info_t loc_rdata_fields[] = {
+  FIELD("version", FIELD_INT8),
+  FIELD("size", FIELD_INT8),
+  FIELD("horizontal precision", FIELD_INT8),
+  FIELD("vertical precision", FIELD_INT8),
+  FIELD("latitude", FIELD_INT32),
+  FIELD("longitude", FIELD_INT32),
+  FIELD("altitude", FIELD_INT32)
+};
+
+static const field_info_t nxt_rdata_fields[] = {
+  CANONICAL_FIELD("next domain name", FIELD_NAME),
+  FIELD("types", FIELD_TYPES)
+};
+
+static const field_info_t srv_rdata_fields[] = {
+  FIELD("priority", FIELD_INT16),
+  FIELD("weight", FIELD_INT16),
+  FIELD("port", FIELD_INT16),
+  CANONICAL_FIELD("target", FIELD_NAME)
+};
+
+static const field_info_t naptr_rdata_fields[] = {
+  FIELD("order", FIELD_INT16),
+  FIELD("preference", FIELD_INT16),
+  FIELD("flags", FIELD_STRING),
+  FIELD("services", FIELD_STRING),
+  FIELD("regex", FIELD_STRING),
+  CANONICAL_FIELD("replacement", FIELD_NAME)
+};
+
+static const field_info_t kx_rdata_fields[] = {
+  FIELD("preference", FIELD_INT16),
+  CANONICAL_FIELD("exchanger", FIELD_NAME)
+};
+
+static const field_info_t cert_rdata_fields[] = {
+  SYMBOLIC_FIELD("type", FIELD_INT16, certificate_types),
+  FIELD("key tag", FIELD_INT16),
+  SYMBOLIC_FIELD("algorithm", FIELD_INT8, algorithms),
+  FIELD("certificate", FIELD_BLOB)
+};
+
+static const field_info_t dname_rdata_fields[] = {
+  CANONICAL_FIELD("source", FIELD_NAME)
+};
+
+static const field_info_t apl_rdata_fields[] = {
+  FIELD("prefixes", FIELD_BLOB)
+};
+
+static const field_info_t ds_rdata_fields[] = {
+  FIELD("keytag", FIELD_INT16),
+  SYMBOLIC_FIELD("algorithm", FIELD_INT8, algorithms),
+  FIELD("digtype", FIELD_INT8),
+  FIELD("digest", FIELD_BLOB)
+};
+
+static const field_info_t sshfp_rdata_fields[] = {
+  FIELD("algorithm", FIELD_INT8),
+  FIELD("ftype", FIELD_INT8),
+  FIELD("fingerprint", FIELD_BLOB)
+};
+
+static const field_info_t ipseckey_rdata_fields[] = {
+  FIELD("precedence", FIELD_INT8),
+  FIELD("gateway type", FIELD_INT8),
+  FIELD("algorithm", FIELD_INT8),
+  FIELD("gateway", FIELD_BLOB),
+  OPTIONAL_FIELD("public key", FIELD_BLOB)
+};
+
+static const field_info_t rrsig_rdata_fields[] = {
+  FIELD("rrtype", FIELD_INT16),
+  SYMBOLIC_FIELD("algorithm", FIELD_INT8, algorithms),
+  FIELD("labels", FIELD_INT8),
+  FIELD("origttl", FIELD_INT32),
+  FIELD("expire", FIELD_INT32),
+  FIELD("inception", FIELD_INT32),
+  FIELD("keytag", FIELD_INT16),
+  CANONICAL_FIELD("signer", FIELD_NAME),
+  FIELD("signature", FIELD_BLOB)
+};
+
+static const field_info_t nsec_rdata_fields[] = {
+  FIELD("next", FIELD_NAME),
+  FIELD("types", FIELD_TYPES)
+};
+
+static const field_info_t dnskey_rdata_fields[] = {
+  FIELD("flags", FIELD_INT16),
+  FIELD("protocol", FIELD_INT8),
+  SYMBOLIC_FIELD("algorithm", FIELD_INT8, algorithms),
+  FIELD("publickey", FIELD_BLOB)
+};
+
+static const field_info_t dhcid_rdata_fields[] = {
+  FIELD("dhcpinfo", FIELD_BLOB)
+};
+
+static const field_info_t nsec3_rdata_fields[] = {
+  FIELD("algorithm", FIELD_INT8),
+  FIELD("flags", FIELD_INT8),
+  FIELD("iterations", FIELD_INT16),
+  FIELD("salt", FIELD_STRING),
+  FIELD("next", FIELD_STRING),
+  FIELD("types", FIELD_TYPES)
+};
+
+static const field_info_t nsec3param_rdata_fields[] = {
+  FIELD("algorithm", FIELD_INT8),
+  FIELD("flags", FIELD_INT8),
+  FIELD("iterations", FIELD_INT16),
+  FIELD("salt", FIELD_STRING)
+};
+
+static const field_info_t tlsa_rdata_fields[] = {
+  FIELD("usage", FIELD_INT8),
+  FIELD("selector", FIELD_INT8),
+  FIELD("matching type", FIELD_INT8),
+  FIELD("certificate association data", FIELD_BLOB)
+};
+
+static const field_info_t hip_rdata_fields[] = {
+  FIELD("hit length", FIELD_INT8),
+  FIELD("algorithm", FIELD_INT8),
+  FIELD("public key length", FIELD_INT16),
+  FIELD("hit", FIELD_BLOB),
+  FIELD("public key", FIELD_BLOB),
+  FIELD("rendezvous servers", FIELD_BLOB)
+};
+
+static const field_info_t openpgpkey_rdata_fields[] = {
+  FIELD("key", FIELD_BLOB)
+};
+
+static const field_info_t csync_rdata_fields[] = {
+  FIELD("serial", FIELD_INT32),
+  FIELD("flags", FIELD_INT16),
+  FIELD("types", FIELD_TYPES)
+};
+
+static const field_info_t zonemd_rdata_fields[] = {
+  FIELD("serial", FIELD_INT32),
+  FIELD("scheme", FIELD_INT8),
+  FIELD("algorithm", FIELD_INT8),
+  FIELD("digest", FIELD_BLOB)
+};
+
+static const field_info_t svcb_rdata_fields[] = {
+  FIELD("priority", FIELD_INT16),
+  FIELD("target", FIELD_NAME),
+  FIELD("params", FIELD_SVC_PARAMS)
+};
+
+static const field_info_t nid_rdata_fields[] = {
+  FIELD("preference", FIELD_INT16),
+  FIELD("node id", FIELD_ILNP64)
+};
+
+static const field_info_t l32_rdata_fields[] = {
+  FIELD("preference", FIELD_INT16),
+  FIELD("locator32", FIELD_IP4)
+};
+
+static const field_info_t l64_rdata_fields[] = {
+  FIELD("preference", FIELD_INT16),
+  FIELD("locator64", FIELD_ILNP64)
+};
+
+static const field_info_t lp_rdata_fields[] = {
+  FIELD("preference", FIELD_INT16),
+  FIELD("fqdn", FIELD_NAME)
+};
+
+static const field_info_t eui48_rdata_fields[] = {
+  FIELD("address", FIELD_EUI48)
+};
+
+static const field_info_t eui64_rdata_fields[] = {
+  FIELD("address", FIELD_EUI64)
+};
+
+static const field_info_t uri_rdata_fields[] = {
+  FIELD("priority", FIELD_INT16),
+  FIELD("weight", FIELD_INT16),
+  FIELD("target", FIELD_BLOB)
+};
+
+static const field_info_t caa_rdata_fields[] = {
+  FIELD("flags", FIELD_INT8),
+  FIELD("tag", FIELD_STRING),
+  FIELD("value", FIELD_BLOB)
+};
+
+// parse functions invoke the field parsers in order. fields that are
+// followed by another field read the next token, fields that consume the
+// remaining tokens (base16, base64, nsec, ...) do not
+#define PARSE_FIELD(parse, index) \
+  if ((code = parse(parser, type, &fields[index], token)) < 0) \
+    return code; \
+  lex(parser, token);
+
+#define PARSE_LAST_FIELD(parse, index) \
+  if ((code = parse(parser, type, &fields[index], token)) < 0) \
+    return code;
+
+#define RDATA_PARSER(name, field_parsers) \
+  zone_nonnull_all() \
+  static int32_t parse_ ## name ## _rdata( \
+    zone_parser_t *parser, const type_info_t *type, token_t *token) \
+  { \
+    int32_t code; \
+    const field_info_t *fields = type->rdata.fields; \
+    field_parsers \
+    if ((code = have_delimiter(parser, type, token)) < 0) \
+      return code; \
+    return accept_rr(parser, parser->user_data); \
+  }
+
+RDATA_PARSER(a,
+  PARSE_FIELD(parse_ip4, 0))
+
+RDATA_PARSER(ns,
+  PARSE_FIELD(parse_name, 0))
+
+RDATA_PARSER(soa,
+  PARSE_FIELD(parse_name, 0)
+  PARSE_FIELD(parse_name, 1)
+  PARSE_FIELD(parse_int32, 2)
+  PARSE_FIELD(parse_ttl, 3)
+  PARSE_FIELD(parse_ttl, 4)
+  PARSE_FIELD(parse_ttl, 5)
+  PARSE_FIELD(parse_ttl, 6))
+
+RDATA_PARSER(wks,
+  PARSE_FIELD(parse_ip4, 0)
+  PARSE_FIELD(parse_symbol8, 1)
+  PARSE_LAST_FIELD(parse_wks_services, 2))
+
+RDATA_PARSER(hinfo,
+  PARSE_FIELD(parse_string, 0)
+  PARSE_FIELD(parse_string, 1))
+
+RDATA_PARSER(minfo,
+  PARSE_FIELD(parse_name, 0)
+  PARSE_FIELD(parse_name, 1))
+
+RDATA_PARSER(mx,
+  PARSE_FIELD(parse_int16, 0)
+  PARSE_FIELD(parse_name, 1))
+
+RDATA_PARSER(txt,
+  PARSE_LAST_FIELD(parse_strings, 0))
+
+RDATA_PARSER(x25,
+  PARSE_FIELD(parse_string, 0))
+
+zone_nonnull_all()
+static int32_t parse_isdn_rdata(
+  zone_parser_t *parser, const type_info_t *type, token_t *token)
+{
+  int32_t code;
+  const field_info_t *fields = type->rdata.fields;
+
+  if ((code = parse_string(parser, type, &fields[0], token)) < 0)
+    return code;
+  lex(parser, token);
+  if (token->code & STRING) {
+    if ((code = parse_string(parser, type, &fields[1], token)) < 0)
+      return code;
+    lex(parser, token);
+  }
+  if ((code = have_delimiter(parser, type, token)) < 0)
+    return code;
+  return accept_rr(parser, parser->user_data);
+}
+
+RDATA_PARSER(px,
+  PARSE_FIELD(parse_int16, 0)
+  PARSE_FIELD(parse_name, 1)
+  PARSE_FIELD(parse_name, 2))
+
+RDATA_PARSER(aaaa,
+  PARSE_FIELD(parse_ip6, 0))
+
+// sizes and precision are optional and precede the coordinates in wire
+// format, defaults are 1m for size, 10000m for horizontal precision and
+// 10m for vertical precision (RFC 1876 section 3)
+zone_nonnull_all()
+static int32_t parse_loc_rdata(
+  zone_parser_t *parser, const type_info_t *type, token_t *token)
+{
+  int32_t code;
+  const field_info_t *fields = type->rdata.fields;
+  uint8_t *octets = parser->rdata.octets + parser->rdata.length;
+
+  octets[0] = 0x00;
+  octets[1] = 0x12;
+  octets[2] = 0x16;
+  octets[3] = 0x13;
+  parser->rdata.length += 4;
+
+  PARSE_FIELD(parse_latitude, 4)
+  PARSE_FIELD(parse_longitude, 5)
+  PARSE_FIELD(parse_altitude, 6)
+  for (size_t i=1; i < 4 && token->code == CONTIGUOUS; i++) {
+    if ((code = scan_precision(parser, type, &fields[i], token, &octets[i])) < 0)
+      return code;
+    lex(parser, token);
+  }
+  if ((code = have_delimiter(parser, type, token)) < 0)
+    return code;
+  return accept_rr(parser, parser->user_data);
+}
+
+RDATA_PARSER(nxt,
+  PARSE_FIELD(parse_name, 0)
+  PARSE_LAST_FIELD(parse_nxt, 1))
+
+RDATA_PARSER(srv,
+  PARSE_FIELD(parse_int16, 0)
+  PARSE_FIELD(parse_int16, 1)
+  PARSE_FIELD(parse_int16, 2)
+  PARSE_FIELD(parse_name, 3))
+
+RDATA_PARSER(naptr,
+  PARSE_FIELD(parse_int16, 0)
+  PARSE_FIELD(parse_int16, 1)
+  PARSE_FIELD(parse_string, 2)
+  PARSE_FIELD(parse_string, 3)
+  PARSE_FIELD(parse_string, 4)
+  PARSE_FIELD(parse_name, 5))
+
+RDATA_PARSER(cert,
+  PARSE_FIELD(parse_symbol16, 0)
+  PARSE_FIELD(parse_int16, 1)
+  PARSE_FIELD(parse_symbol8, 2)
+  PARSE_LAST_FIELD(parse_base64, 3))
+
+RDATA_PARSER(apl,
+  PARSE_LAST_FIELD(parse_apl, 0))
+
+RDATA_PARSER(ds,
+  PARSE_FIELD(parse_int16, 0)
+  PARSE_FIELD(parse_symbol8, 1)
+  PARSE_FIELD(parse_int8, 2)
+  PARSE_LAST_FIELD(parse_base16, 3))
+
+RDATA_PARSER(sshfp,
+  PARSE_FIELD(parse_int8, 0)
+  PARSE_FIELD(parse_int8, 1)
+  PARSE_LAST_FIELD(parse_base16, 2))
+
+// public key may be omitted (RFC 4025 section 3)
+zone_nonnull_all()
+static int32_t parse_ipseckey_rdata(
+  zone_parser_t *parser, const type_info_t *type, token_t *token)
+{
+  int32_t code;
+  const field_info_t *fields = type->rdata.fields;
+
+  PARSE_FIELD(parse_int8, 0)
+  PARSE_FIELD(parse_int8, 1)
+  PARSE_FIELD(parse_int8, 2)
+  PARSE_FIELD(parse_gateway, 3)
+  if (token->code == CONTIGUOUS) {
+    PARSE_LAST_FIELD(parse_base64, 4)
+  }
+  if ((code = have_delimiter(parser, type, token)) < 0)
+    return code;
+  return accept_rr(parser, parser->user_data);
+}
+
+RDATA_PARSER(rrsig,
+  PARSE_FIELD(parse_type, 0)
+  PARSE_FIELD(parse_symbol8, 1)
+  PARSE_FIELD(parse_int8, 2)
+  PARSE_FIELD(parse_ttl, 3)
+  PARSE_FIELD(parse_time, 4)
+  PARSE_FIELD(parse_time, 5)
+  PARSE_FIELD(parse_int16, 6)
+  PARSE_FIELD(parse_name, 7)
+  PARSE_LAST_FIELD(parse_base64, 8))
+
+RDATA_PARSER(nsec,
+  PARSE_FIELD(parse_name, 0)
+  PARSE_LAST_FIELD(parse_nsec, 1))
+
+RDATA_PARSER(dnskey,
+  PARSE_FIELD(parse_int16, 0)
+  PARSE_FIELD(parse_int8, 1)
+  PARSE_FIELD(parse_symbol8, 2)
+  PARSE_LAST_FIELD(parse_base64, 3))
+
+RDATA_PARSER(dhcid,
+  PARSE_LAST_FIELD(parse_base64, 0))
+
+RDATA_PARSER(nsec3,
+  PARSE_FIELD(parse_int8, 0)
+  PARSE_FIELD(parse_int8, 1)
+  PARSE_FIELD(parse_int16, 2)
+  PARSE_FIELD(parse_salt, 3)
+  PARSE_FIELD(parse_base32, 4)
+  PARSE_LAST_FIELD(parse_nsec, 5))
+
+RDATA_PARSER(nsec3param,
+  PARSE_FIELD(parse_int8, 0)
+  PARSE_FIELD(parse_int8, 1)
+  PARSE_FIELD(parse_int16, 2)
+  PARSE_FIELD(parse_salt, 3))
+
+RDATA_PARSER(tlsa,
+  PARSE_FIELD(parse_int8, 0)
+  PARSE_FIELD(parse_int8, 1)
+  PARSE_FIELD(parse_int8, 2)
+  PARSE_LAST_FIELD(parse_base16, 3))
+
+// lengths of HIT and public key precede the HIT in wire format, the HIT is
+// parsed as a length-prefixed string that overlaps the public key length
+// (RFC 8005 section 4)
+zone_nonnull_all()
+static int32_t parse_hip_rdata(
+  zone_parser_t *parser, const type_info_t *type, token_t *token)
+{
+  int32_t code;
+  const field_info_t *fields = type->rdata.fields;
+  uint8_t *octets = parser->rdata.octets + parser->rdata.length;
+  uint64_t algorithm = 0;
+
+  if ((code = scan_int(parser, type, &fields[1], token, UINT8_MAX, &algorithm)) < 0)
+    return code;
+  lex(parser, token);
+  parser->rdata.length += 3;
+  PARSE_FIELD(parse_salt, 3)
+  if (!octets[3])
+    return invalid_field(parser, type, &fields[3]);
+  octets[0] = octets[3];
+  octets[1] = (uint8_t)algorithm;
+  const size_t length = parser->rdata.length;
+  PARSE_FIELD(parse_base64_token, 4)
+  write_int16(&octets[2], (uint16_t)(parser->rdata.length - length));
+  while (token->code & STRING) {
+    if (parser->rdata.length + 255 > 65535)
+      return rdata_too_long(parser, type, &fields[5]);
+    PARSE_FIELD(parse_name, 5)
+  }
+  if ((code = have_delimiter(parser, type, token)) < 0)
+    return code;
+  return accept_rr(parser, parser->user_data);
+}
+
+RDATA_PARSER(csync,
+  PARSE_FIELD(parse_int32, 0)
+  PARSE_FIELD(parse_int16, 1)
+  PARSE_LAST_FIELD(parse_nsec, 2))
+
+RDATA_PARSER(zonemd,
+  PARSE_FIELD(parse_int32, 0)
+  PARSE_FIELD(parse_int8, 1)
+  PARSE_FIELD(parse_int8, 2)
+  PARSE_LAST_FIELD(parse_base16, 3))
+
+RDATA_PARSER(svcb,
+  PARSE_FIELD(parse_int16, 0)
+  PARSE_FIELD(parse_name, 1)
+  PARSE_LAST_FIELD(parse_svc_params, 2))
+
+RDATA_PARSER(nid,
+  PARSE_FIELD(parse_int16, 0)
+  PARSE_FIELD(parse_ilnp64, 1))
+
+RDATA_PARSER(l32,
+  PARSE_FIELD(parse_int16, 0)
+  PARSE_FIELD(parse_ip4, 1))
+
+RDATA_PARSER(eui48,
+  PARSE_FIELD(parse_eui48, 0))
+
+RDATA_PARSER(eui64,
+  PARSE_FIELD(parse_eui64, 0))
+
+RDATA_PARSER(uri,
+  PARSE_FIELD(parse_int16, 0)
+  PARSE_FIELD(parse_int16, 1)
+  PARSE_FIELD(parse_text, 2))
+
+RDATA_PARSER(caa,
+  PARSE_FIELD(parse_int8, 0)
+  PARSE_FIELD(parse_caa_tag, 1)
+  PARSE_FIELD(parse_text, 2))
+
+zone_nonnull_all()
+static int32_t parse_unimplemented_rdata(
+  zone_parser_t *parser, const type_info_t *type, token_t *token)
+{
+  (void)token;
+  NOT_IMPLEMENTED(parser, "%.*s not implemented, use generic notation",
+                  NAME(type));
+}
+
+zone_nonnull_all()
+static int32_t parse_unknown_rdata(
+  zone_parser_t *parser, const type_info_t *type, token_t *token)
+{
+  (void)type;
+  (void)token;
+  SYNTAX_ERROR(parser, "Unknown type %u, use generic notation",
+               (unsigned)parser->file->last_type);
+}
+
+#define TYPE_INFO(name, code, bound, fields, parse) \
+  { { sizeof(name) - 1, name }, code, bound, \
+    { sizeof(fields) / sizeof(fields[0]), fields }, parse }
+
+// NULL has no presentation format (RFC 1035 section 3.3.10)
+#define UNIMPLEMENTED_TYPE(name, code) \
+  { { sizeof(name) - 1, name }, code, 65535, { 0, NULL }, \
+    parse_unimplemented_rdata }
+
+// types without descriptor are zero-initialized
+static const type_info_t types[] = {
+  [ZONE_A] = TYPE_INFO("A", ZONE_A, 4, a_rdata_fields, parse_a_rdata),
+  [ZONE_NS] = TYPE_INFO("NS", ZONE_NS, 255, ns_rdata_fields, parse_ns_rdata),
+  [ZONE_MD] = TYPE_INFO("MD", ZONE_MD, 255, md_rdata_fields, parse_ns_rdata),
+  [ZONE_MF] = TYPE_INFO("MF", ZONE_MF, 255, mf_rdata_fields, parse_ns_rdata),
+  [ZONE_CNAME] = TYPE_INFO("CNAME", ZONE_CNAME, 255, cname_rdata_fields, parse_ns_rdata),
+  [ZONE_SOA] = TYPE_INFO("SOA", ZONE_SOA, 2 * 255 + 20, soa_rdata_fields, parse_soa_rdata),
+  [ZONE_MB] = TYPE_INFO("MB", ZONE_MB, 255, mb_rdata_fields, parse_ns_rdata),
+  [ZONE_MG] = TYPE_INFO("MG", ZONE_MG, 255, mg_rdata_fields, parse_ns_rdata),
+  [ZONE_MR] = TYPE_INFO("MR", ZONE_MR, 255, mr_rdata_fields, parse_ns_rdata),
+  [ZONE_NULL] = UNIMPLEMENTED_TYPE("NULL", ZONE_NULL),
+  [ZONE_WKS] = TYPE_INFO("WKS", ZONE_WKS, 5 + 8192, wks_rdata_fields, parse_wks_rdata),
+  [ZONE_PTR] = TYPE_INFO("PTR", ZONE_PTR, 255, ptr_rdata_fields, parse_ns_rdata),
+  [ZONE_HINFO] = TYPE_INFO("HINFO", ZONE_HINFO, 2 * 256, hinfo_rdata_fields, parse_hinfo_rdata),
+  [ZONE_MINFO] = TYPE_INFO("MINFO", ZONE_MINFO, 2 * 255, minfo_rdata_fields, parse_minfo_rdata),
+  [ZONE_MX] = TYPE_INFO("MX", ZONE_MX, 2 + 255, mx_rdata_fields, parse_mx_rdata),
+  [ZONE_TXT] = TYPE_INFO("TXT", ZONE_TXT, 65535, txt_rdata_fields, parse_txt_rdata),
+  [ZONE_RP] = TYPE_INFO("RP", ZONE_RP, 2 * 255, rp_rdata_fields, parse_minfo_rdata),
+  [ZONE_AFSDB] = TYPE_INFO("AFSDB", ZONE_AFSDB, 2 + 255, afsdb_rdata_fields, parse_mx_rdata),
+  [ZONE_X25] = TYPE_INFO("X25", ZONE_X25, 256, x25_rdata_fields, parse_x25_rdata),
+  [ZONE_ISDN] = TYPE_INFO("ISDN", ZONE_ISDN, 2 * 256, isdn_rdata_fields, parse_isdn_rdata),
+  [ZONE_RT] = TYPE_INFO("RT", ZONE_RT, 2 + 255, rt_rdata_fields, parse_mx_rdata),
+  [ZONE_SIG] = TYPE_INFO("SIG", ZONE_SIG, 65535, rrsig_rdata_fields, parse_rrsig_rdata),
+  [ZONE_KEY] = TYPE_INFO("KEY", ZONE_KEY, 65535, dnskey_rdata_fields, parse_dnskey_rdata),
+  [ZONE_PX] = TYPE_INFO("PX", ZONE_PX, 2 + 2 * 255, px_rdata_fields, parse_px_rdata),
+  [ZONE_AAAA] = TYPE_INFO("AAAA", ZONE_AAAA, 16, aaaa_rdata_fields, parse_aaaa_rdata),
+  [ZONE_LOC] = TYPE_INFO("LOC", ZONE_LOC, 16, loc_rdata_fields, parse_loc_rdata),
+  [ZONE_NXT] = TYPE_INFO("NXT", ZONE_NXT, 255 + 16, nxt_rdata_fields, parse_nxt_rdata),
+  [ZONE_SRV] = TYPE_INFO("SRV", ZONE_SRV, 6 + 255, srv_rdata_fields, parse_srv_rdata),
+  [ZONE_NAPTR] = TYPE_INFO("NAPTR", ZONE_NAPTR, 4 + 3 * 256 + 255, naptr_rdata_fields, parse_naptr_rdata),
+  [ZONE_KX] = TYPE_INFO("KX", ZONE_KX, 2 + 255, kx_rdata_fields, parse_mx_rdata),
+  [ZONE_CERT] = TYPE_INFO("CERT", ZONE_CERT, 65535, cert_rdata_fields, parse_cert_rdata),
+  [ZONE_DNAME] = TYPE_INFO("DNAME", ZONE_DNAME, 255, dname_rdata_fields, parse_ns_rdata),
+  [ZONE_APL] = TYPE_INFO("APL", ZONE_APL, 65535, apl_rdata_fields, parse_apl_rdata),
+  [ZONE_DS] = TYPE_INFO("DS", ZONE_DS, 65535, ds_rdata_fields, parse_ds_rdata),
+  [ZONE_SSHFP] = TYPE_INFO("SSHFP", ZONE_SSHFP, 65535, sshfp_rdata_fields, parse_sshfp_rdata),
+  [ZONE_IPSECKEY] = TYPE_INFO("IPSECKEY", ZONE_IPSECKEY, 65535, ipseckey_rdata_fields, parse_ipseckey_rdata),
+  [ZONE_RRSIG] = TYPE_INFO("RRSIG", ZONE_RRSIG, 65535, rrsig_rdata_fields, parse_rrsig_rdata),
+  [ZONE_NSEC] = TYPE_INFO("NSEC", ZONE_NSEC, 255 + TYPE_BITMAP_SIZE, nsec_rdata_fields, parse_nsec_rdata),
+  [ZONE_DNSKEY] = TYPE_INFO("DNSKEY", ZONE_DNSKEY, 65535, dnskey_rdata_fields, parse_dnskey_rdata),
+  [ZONE_DHCID] = TYPE_INFO("DHCID", ZONE_DHCID, 65535, dhcid_rdata_fields, parse_dhcid_rdata),
+  [ZONE_NSEC3] = TYPE_INFO("NSEC3", ZONE_NSEC3, 4 + 2 * 256 + TYPE_BITMAP_SIZE, nsec3_rdata_fields, parse_nsec3_rdata),
+  [ZONE_NSEC3PARAM] = TYPE_INFO("NSEC3PARAM", ZONE_NSEC3PARAM, 4 + 256, nsec3param_rdata_fields, parse_nsec3param_rdata),
+  [ZONE_TLSA] = TYPE_INFO("TLSA", ZONE_TLSA, 65535, tlsa_rdata_fields, parse_tlsa_rdata),
+  [ZONE_SMIMEA] = TYPE_INFO("SMIMEA", ZONE_SMIMEA, 65535, tlsa_rdata_fields, parse_tlsa_rdata),
+  [ZONE_HIP] = TYPE_INFO("HIP", ZONE_HIP, 65535, hip_rdata_fields, parse_hip_rdata),
+  [ZONE_CDS] = TYPE_INFO("CDS", ZONE_CDS, 65535, ds_rdata_fields, parse_ds_rdata),
+  [ZONE_CDNSKEY] = TYPE_INFO("CDNSKEY", ZONE_CDNSKEY, 65535, dnskey_rdata_fields, parse_dnskey_rdata),
+  [ZONE_OPENPGPKEY] = TYPE_INFO("OPENPGPKEY", ZONE_OPENPGPKEY, 65535, openpgpkey_rdata_fields, parse_dhcid_rdata),
+  [ZONE_CSYNC] = TYPE_INFO("CSYNC", ZONE_CSYNC, 6 + TYPE_BITMAP_SIZE, csync_rdata_fields, parse_csync_rdata),
+  [ZONE_ZONEMD] = TYPE_INFO("ZONEMD", ZONE_ZONEMD, 65535, zonemd_rdata_fields, parse_zonemd_rdata),
+  [ZONE_SVCB] = TYPE_INFO("SVCB", ZONE_SVCB, 65535, svcb_rdata_fields, parse_svcb_rdata),
+  [ZONE_HTTPS] = TYPE_INFO("HTTPS", ZONE_HTTPS, 65535, svcb_rdata_fields, parse_svcb_rdata),
+  [ZONE_SPF] = TYPE_INFO("SPF", ZONE_SPF, 65535, txt_rdata_fields, parse_txt_rdata),
+  [ZONE_NID] = TYPE_INFO("NID", ZONE_NID, 10, nid_rdata_fields, parse_nid_rdata),
+  [ZONE_L32] = TYPE_INFO("L32", ZONE_L32, 6, l32_rdata_fields, parse_l32_rdata),
+  [ZONE_L64] = TYPE_INFO("L64", ZONE_L64, 10, l64_rdata_fields, parse_nid_rdata),
+  [ZONE_LP] = TYPE_INFO("LP", ZONE_LP, 2 + 255, lp_rdata_fields, parse_mx_rdata),
+  [ZONE_EUI48] = TYPE_INFO("EUI48", ZONE_EUI48, 6, eui48_rdata_fields, parse_eui48_rdata),
+  [ZONE_EUI64] = TYPE_INFO("EUI64", ZONE_EUI64, 8, eui64_rdata_fields, parse_eui64_rdata),
+  [ZONE_URI] = TYPE_INFO("URI", ZONE_URI, 65535, uri_rdata_fields, parse_uri_rdata),
+  [ZONE_CAA] = TYPE_INFO("CAA", ZONE_CAA, 65535, caa_rdata_fields, parse_caa_rdata)
+};
+
+static const type_info_t dlv_type =
+  TYPE_INFO("DLV", ZONE_DLV, 65535, ds_rdata_fields, parse_ds_rdata);
+
+static const type_info_t unknown_type =
+  { { 7, "unknown" }, 0, 65535, { 0, NULL }, parse_unknown_rdata };
+
+static zone_inline const type_info_t *type_info(uint16_t code)
+{
+  if (code < sizeof(types) / sizeof(types[0]) && types[code].parse)
+    return &types[code];
+  if (code == ZONE_DLV)
+    return &dlv_type;
+  return &unknown_type;
+}
+
+#endif // TYPES_H
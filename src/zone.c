@@ -21,6 +21,8 @@
 #include "zone.h"
 #include "diagnostic.h"
 #include "isadetection.h"
+#include "heap.h"
+#include "accept.h"
 
 #if _WIN32
 #define strcasecmp(s1, s2) _stricmp(s1, s2)
@@ -31,24 +33,28 @@ static const char not_a_file[] = "<string>";
 
 static int32_t check_options(const zone_options_t *options)
 {
-//  if (!options->accept.add)
-//    return ZONE_BAD_PARAMETER;
-//  if (!options->origin)
-//    return ZONE_BAD_PARAMETER;
-//  if (!options->default_ttl || options->default_ttl > INT32_MAX)
-//    return ZONE_BAD_PARAMETER;
-//  if (!options->default_class)
-//    should set default_class to ZONE_IN if 0!
-
-//  switch (options->default_class) {
-//    case ZONE_IN:
-//    case ZONE_CS:
-//    case ZONE_CH:
-//    case ZONE_HS:
-//      break;
-//    default:
-//      return ZONE_BAD_PARAMETER;
-//  }
+  const zone_allocator_t *allocator = &options->allocator;
+
+  if (!allocator->malloc != !allocator->realloc ||
+      !allocator->malloc != !allocator->free)
+    return ZONE_BAD_PARAMETER;
+  if (!!options->accept.add + !!options->accept.batch + !!options->accept.stream != 1)
+    return ZONE_BAD_PARAMETER;
+  if (!options->origin)
+    return ZONE_BAD_PARAMETER;
+  if (options->default_ttl > INT32_MAX)
+    return ZONE_BAD_PARAMETER;
+
+  switch (options->default_class) {
+    case 0: // defaults to IN
+    case ZONE_IN:
+    case ZONE_CS:
+    case ZONE_CH:
+    case ZONE_HS:
+      break;
+    default:
+      return ZONE_BAD_PARAMETER;
+  }
 
   return 0;
 }
@@ -90,31 +96,81 @@ static int parse_origin(const char *origin, uint8_t str[255], size_t *len)
 //#include "config.h"
 #include "isadetection.h"
 
+zone_nonnull_all()
+static void initialize_file(zone_file_t *file)
+{
+  // window and paths are retained, initialize everything but the tape
+  file->includer = NULL;
+  file->last_type = 0;
+  file->last_class = 0;
+  file->last_ttl = 0;
+  file->default_ttl = 0;
+  file->have_default_ttl = false;
+  file->line = 1;
+  file->name = NULL;
+  file->path = NULL;
+  file->handle = NULL;
+  file->grouped = false;
+  file->start_of_line = true;
+  file->end_of_file = ZONE_HAVE_DATA;
+  file->buffer.index = 0;
+  file->buffer.length = 0;
+  file->indexer.lines = 0;
+  file->indexer.in_comment = 0;
+  file->indexer.in_quoted = 0;
+  file->indexer.is_escaped = 0;
+  file->indexer.follows_contiguous = 0;
+  file->indexer.head = file->indexer.tape;
+  file->indexer.tail = file->indexer.tape;
+}
+
 zone_nonnull_all()
 static int32_t open_file(
   zone_parser_t *parser, zone_file_t *file, const zone_string_t *path)
 {
-  if (!(file->name = strndup(path->data, path->length)))
-    return ZONE_OUT_OF_MEMORY;
+  size_t size;
+  char *paths;
 
 #if _WIN32
-  char buf[1];
-  size_t length, size = GetFullPathName(file->name, sizeof(buf), buf, NULL);
-  if (!size)
-    return ZONE_IO_ERROR;
-  if (!(file->path = malloc(parser, size)))
+  char buf[1], *name;
+  if (!(name = zone_malloc(parser, path->length + 1)))
     return ZONE_OUT_OF_MEMORY;
-  if (!(length = GetFullPathName(file->name, size, file->path, NULL)))
+  memcpy(name, path->data, path->length);
+  name[path->length] = '\0';
+  size_t length = GetFullPathName(name, sizeof(buf), buf, NULL);
+  zone_free(parser, name);
+  if (!length)
+    return ZONE_IO_ERROR;
+  size = path->length + 1 + length;
+#else
+  size = path->length + 1 + PATH_MAX;
+#endif
+
+  // name and path share storage, which is retained by reusable parsers
+  if (size > file->paths.size) {
+    if (!(paths = zone_realloc(parser, file->paths.data, size)))
+      return ZONE_OUT_OF_MEMORY;
+    file->paths.size = size;
+    file->paths.data = paths;
+  }
+
+  paths = file->paths.data;
+  memcpy(paths, path->data, path->length);
+  paths[path->length] = '\0';
+  file->name = paths;
+  paths += path->length + 1;
+  size -= path->length + 1;
+
+#if _WIN32
+  if (!(length = GetFullPathName(file->name, size, paths, NULL)))
     return ZONE_IO_ERROR;
   if (length != size - 1)
     return ZONE_IO_ERROR;
 #else
-  char buf[PATH_MAX];
-  if (!realpath(file->name, buf))
+  if (!realpath(file->name, paths))
     return ZONE_IO_ERROR;
-  if (!(file->path = strdup(buf)))
-    return ZONE_OUT_OF_MEMORY;
 #endif
+  file->path = paths;
 
   if (!(file->handle = fopen(file->path, "rb")))
     switch (errno) {
@@ -124,19 +180,15 @@ static int32_t open_file(
         return ZONE_IO_ERROR;
     }
 
-  if (!(file->buffer.data = malloc(ZONE_WINDOW_SIZE + 1)))
-    return ZONE_OUT_OF_MEMORY;
+  if (!file->buffer.data) {
+    if (!(file->buffer.data = zone_malloc(parser, ZONE_WINDOW_SIZE + 1 + ZONE_PADDING_SIZE)))
+      return ZONE_OUT_OF_MEMORY;
+    file->buffer.size = ZONE_WINDOW_SIZE;
+  }
 
   file->buffer.data[0] = '\0';
-  file->buffer.size = ZONE_WINDOW_SIZE;
-  file->buffer.length = 0;
-  file->buffer.index = 0;
-  file->start_of_line = true;
-  file->end_of_file = ZONE_HAVE_DATA;
   file->indexer.tape[0].data = file->buffer.data;
   file->indexer.tape[1].data = NULL;
-  file->indexer.head = file->indexer.tape;
-  file->indexer.tail = file->indexer.tape;
   return 0;
 }
 
@@ -144,8 +196,27 @@ static void set_defaults(zone_parser_t *parser)
 {
   if (!parser->options.log.write && !parser->options.log.categories)
     parser->options.log.categories = (uint32_t)-1;
-  parser->owner = &parser->file->owner;
-  parser->rdata = &parser->buffers.rdata.buffers[0];
+  parser->owner = &parser->buffers.owner.buffers[0];
+  *parser->owner = parser->file->origin;
+  parser->same_owner = false;
+  parser->reverted_owner = false;
+  parser->last_owner.length = 0;
+  parser->rdata.length = 0;
+  if (parser->buffers.arena.octets)
+    parser->rdata.octets = parser->buffers.arena.octets;
+  else
+    parser->rdata.octets = parser->buffers.rdata.buffers[0].octets;
+}
+
+zone_nonnull_all()
+static void release_file(zone_parser_t *parser, zone_file_t *file)
+{
+  zone_free(parser, file->buffer.data);
+  file->buffer.data = NULL;
+  file->buffer.size = 0;
+  zone_free(parser, file->paths.data);
+  file->paths.data = NULL;
+  file->paths.size = 0;
 }
 
 diagnostic_push()
@@ -161,19 +232,25 @@ void zone_close_file(
   if (!file->handle)
     return;
 
-  if (file->buffer.data)
-    free(file->buffer.data);
-  file->buffer.data = NULL;
-  if (file->name)
-    free((char *)file->name);
-  file->name = NULL;
-  if (file->path)
-    free((char *)file->path);
-  file->path = NULL;
   (void)fclose(file->handle);
   file->handle = NULL;
-  if (file != &parser->first)
-    free(file);
+  file->name = NULL;
+  file->path = NULL;
+
+  if (!parser->cache.retain) {
+    release_file(parser, file);
+    if (file != &parser->first)
+      zone_free(parser, file);
+  } else if (file == &parser->first) {
+    // window of first file is stashed for the next file or string input
+    parser->cache.window.size = file->buffer.size;
+    parser->cache.window.data = file->buffer.data;
+    file->buffer.size = 0;
+    file->buffer.data = NULL;
+  } else {
+    file->includer = parser->cache.files;
+    parser->cache.files = file;
+  }
 }
 
 zone_nonnull_all()
@@ -183,16 +260,33 @@ int32_t zone_open_file(
   int32_t result;
   zone_file_t *file;
 
-  if (!(file = malloc(sizeof(*file))))
-    return ZONE_OUT_OF_MEMORY;
-  memset(file, 0, sizeof(*file) - sizeof(file->indexer.tape));
+  if ((file = parser->cache.files)) {
+    parser->cache.files = file->includer;
+  } else {
+    if (!(file = zone_malloc(parser, sizeof(*file))))
+      return ZONE_OUT_OF_MEMORY;
+    file->paths.size = 0;
+    file->paths.data = NULL;
+    file->buffer.size = 0;
+    file->buffer.data = NULL;
+  }
+
+  initialize_file(file);
   if ((result = open_file(parser, file, path)) < 0)
     goto err_open;
 
   *fileptr = file;
   return 0;
 err_open:
-  zone_close_file(parser, file);
+  if (file->handle) {
+    zone_close_file(parser, file);
+  } else if (parser->cache.retain) {
+    file->includer = parser->cache.files;
+    parser->cache.files = file;
+  } else {
+    release_file(parser, file);
+    zone_free(parser, file);
+  }
   return result;
 }
 
@@ -208,11 +302,13 @@ void zone_close(zone_parser_t *parser)
   }
 }
 
-int32_t zone_open(
+diagnostic_pop()
+
+zone_nonnull((1,2,3))
+static int32_t initialize(
   zone_parser_t *parser,
   const zone_options_t *options,
   zone_buffers_t *buffers,
-  const char *path,
   void *user_data)
 {
   int32_t result;
@@ -220,39 +316,196 @@ int32_t zone_open(
 
   if ((result = check_options(options)) < 0)
     return result;
+  if (!buffers->size)
+    return ZONE_BAD_PARAMETER;
 
-  memset(parser, 0, sizeof(*parser));
   parser->options = *options;
   parser->user_data = user_data;
   file = parser->file = &parser->first;
-  if ((result = open_file(parser, file, &(zone_string_t){ strlen(path), path })) < 0)
-    goto error;
-  if (parse_origin(options->origin, file->origin.octets, &file->origin.length) < 0) {
-    result = ZONE_BAD_PARAMETER;
-    goto error;
-  }
+  initialize_file(file);
+  if (parse_origin(options->origin, file->origin.octets, &file->origin.length) < 0)
+    return ZONE_BAD_PARAMETER;
   parser->buffers.size = buffers->size;
   parser->buffers.owner.index = 0;
   parser->buffers.owner.buffers = buffers->owner;
   parser->buffers.rdata.index = 0;
   parser->buffers.rdata.buffers = buffers->rdata;
-  file->owner = file->origin;
-  file->last_type = 0;
-  file->last_class = options->default_class;
+  parser->buffers.arena.size = buffers->arena.size;
+  parser->buffers.arena.length = 0;
+  parser->buffers.arena.octets = buffers->arena.octets;
+  file->last_class = options->default_class ? options->default_class : ZONE_IN;
   file->last_ttl = options->default_ttl;
-  file->line = 1;
+  file->default_ttl = options->default_ttl;
+
+  parser->batch.size = 1;
+  parser->batch.length = 0;
+  if (options->accept.batch) {
+    size_t size = options->accept.batch_size;
+    if (!size)
+      size = buffers->size;
+    else if (size > buffers->size)
+      return ZONE_BAD_PARAMETER;
+    if (size > parser->batch.capacity) {
+      zone_record_t *records;
+      if (!(records = zone_realloc(
+              parser, parser->batch.records, size * sizeof(*records))))
+        return ZONE_OUT_OF_MEMORY;
+      parser->batch.capacity = size;
+      parser->batch.records = records;
+    }
+    parser->batch.size = size;
+  }
 
   set_defaults(parser);
   return 0;
+}
+
+zone_nonnull((1,2,3,4))
+static int32_t open_zone(
+  zone_parser_t *parser,
+  const zone_options_t *options,
+  zone_buffers_t *buffers,
+  const char *path,
+  void *user_data)
+{
+  int32_t result;
+  zone_file_t *file = &parser->first;
+
+  if ((result = initialize(parser, options, buffers, user_data)) < 0)
+    return result;
+
+  file->buffer.size = parser->cache.window.size;
+  file->buffer.data = parser->cache.window.data;
+  parser->cache.window.size = 0;
+  parser->cache.window.data = NULL;
+  if ((result = open_file(parser, file, &(zone_string_t){ strlen(path), path })) < 0)
+    goto error;
+  return 0;
 error:
-  zone_close(parser);
+  if (file->handle) {
+    zone_close(parser);
+  } else if (parser->cache.retain) {
+    parser->cache.window.size = file->buffer.size;
+    parser->cache.window.data = file->buffer.data;
+    file->buffer.size = 0;
+    file->buffer.data = NULL;
+  } else {
+    release_file(parser, file);
+  }
   return result;
 }
 
-diagnostic_pop()
+// strings are read into a window like files so that input need not be
+// padded, the window of the first file is shared with file input
+zone_nonnull_all()
+static int32_t open_string(
+  zone_parser_t *parser, const char *string, size_t length)
+{
+  zone_file_t *file = parser->file;
+
+  file->buffer.size = parser->cache.window.size;
+  file->buffer.data = parser->cache.window.data;
+  parser->cache.window.size = 0;
+  parser->cache.window.data = NULL;
+  if (!file->buffer.data) {
+    if (!(file->buffer.data = zone_malloc(parser, ZONE_WINDOW_SIZE + 1 + ZONE_PADDING_SIZE)))
+      return ZONE_OUT_OF_MEMORY;
+    file->buffer.size = ZONE_WINDOW_SIZE;
+  }
+
+  file->name = not_a_file;
+  file->path = not_a_file;
+  file->handle = NULL;
+  file->string.index = 0;
+  file->string.length = length;
+  file->string.data = string;
+  file->buffer.data[0] = '\0';
+  file->indexer.tape[0].data = file->buffer.data;
+  file->indexer.tape[1].data = NULL;
+  return 0;
+}
+
+zone_nonnull_all()
+static void close_string(zone_parser_t *parser)
+{
+  zone_file_t *file = &parser->first;
+
+  if (parser->cache.retain) {
+    parser->cache.window.size = file->buffer.size;
+    parser->cache.window.data = file->buffer.data;
+  } else {
+    zone_free(parser, file->buffer.data);
+  }
+  file->buffer.size = 0;
+  file->buffer.data = NULL;
+}
+
+zone_nonnull_all()
+static void release(zone_parser_t *parser)
+{
+  for (zone_file_t *file = parser->cache.files, *next; file; file = next) {
+    next = file->includer;
+    release_file(parser, file);
+    zone_free(parser, file);
+  }
+  parser->cache.files = NULL;
+  zone_free(parser, parser->cache.window.data);
+  parser->cache.window.size = 0;
+  parser->cache.window.data = NULL;
+  // buffer of first file is stashed when the file or string is closed
+  zone_free(parser, parser->first.paths.data);
+  parser->first.paths.size = 0;
+  parser->first.paths.data = NULL;
+  zone_free(parser, parser->batch.records);
+  parser->batch.capacity = 0;
+  parser->batch.records = NULL;
+}
+
+zone_nonnull_all()
+static bool same_allocator(
+  const zone_allocator_t *allocator1, const zone_allocator_t *allocator2)
+{
+  return allocator1->malloc == allocator2->malloc &&
+         allocator1->realloc == allocator2->realloc &&
+         allocator1->free == allocator2->free &&
+         allocator1->arena == allocator2->arena;
+}
+
+zone_nonnull_all()
+static void clear(zone_parser_t *parser)
+{
+  memset(&parser->options.allocator, 0, sizeof(parser->options.allocator));
+  parser->cache.retain = false;
+  parser->cache.window.size = 0;
+  parser->cache.window.data = NULL;
+  parser->cache.files = NULL;
+  parser->file = &parser->first;
+  parser->first.includer = NULL;
+  parser->first.handle = NULL;
+  parser->first.paths.size = 0;
+  parser->first.paths.data = NULL;
+  parser->first.buffer.size = 0;
+  parser->first.buffer.data = NULL;
+  parser->batch.capacity = 0;
+  parser->batch.records = NULL;
+}
 
 extern int32_t parse(zone_parser_t *parser, void *user_data);
 
+zone_nonnull((1))
+static int32_t parse_and_flush(zone_parser_t *parser, void *user_data)
+{
+  int32_t result = parse(parser, user_data);
+
+  // records accepted before an error are delivered too, like in add mode
+  if (parser->options.accept.batch) {
+    const int32_t flushed = flush_batch(parser, user_data);
+    if (result >= 0)
+      result = flushed;
+  }
+  return result;
+}
+
 int32_t zone_parse(
   zone_parser_t *parser,
   const zone_options_t *options,
@@ -262,10 +515,12 @@ int32_t zone_parse(
 {
   int32_t result;
 
-  if ((result = zone_open(parser, options, buffers, path, user_data)) < 0)
-    return result;
-  result = parse(parser, user_data);
-  zone_close(parser);
+  clear(parser);
+  if ((result = open_zone(parser, options, buffers, path, user_data)) == 0) {
+    result = parse_and_flush(parser, user_data);
+    zone_close(parser);
+  }
+  release(parser);
   return result;
 }
 
@@ -278,45 +533,88 @@ int32_t zone_parse_string(
   void *user_data)
 {
   int32_t result;
-  zone_file_t *file;
 
-  if ((result = check_options(options)) < 0)
-    return result;
+  clear(parser);
+  if ((result = initialize(parser, options, buffers, user_data)) == 0 &&
+      (result = open_string(parser, string, length)) == 0) {
+    result = parse_and_flush(parser, user_data);
+    zone_close(parser);
+  }
+  close_string(parser);
+  release(parser);
+  return result;
+}
 
-  memset(parser, 0, sizeof(*parser));
-  parser->options = *options;
-  parser->user_data = user_data;
-  file = parser->file = &parser->first;
-  if ((result = parse_origin(options->origin, file->origin.octets, &file->origin.length)) < 0)
-    return result;
+zone_parser_t *zone_parser_create(void)
+{
+  zone_parser_t *parser;
 
-  file->name = not_a_file;
-  file->path = not_a_file;
-  file->handle = NULL;
-  file->buffer.index = 0;
-  file->buffer.length = length;
-  file->buffer.size = length;
-  file->buffer.data = (char *)string;
-  file->start_of_line = true;
-  file->end_of_file = ZONE_READ_ALL_DATA;
-  file->indexer.tape[0].data = "\0";
-  file->indexer.tape[1].data = NULL;
-  file->indexer.head = file->indexer.tape;
-  file->indexer.tail = file->indexer.tape;
+  if (!(parser = malloc(sizeof(*parser))))
+    return NULL;
+  clear(parser);
+  parser->cache.retain = true;
+  return parser;
+}
 
-  parser->buffers.size = buffers->size;
-  parser->buffers.owner.index = 0;
-  parser->buffers.owner.buffers = buffers->owner;
-  parser->buffers.rdata.index = 0;
-  parser->buffers.rdata.buffers = buffers->rdata;
-  file->owner = file->origin;
-  file->last_type = 0;
-  file->last_class = options->default_class;
-  file->last_ttl = options->default_ttl;
-  file->line = 1;
+void zone_parser_reset(zone_parser_t *parser)
+{
+  zone_close(parser);
+  parser->file = &parser->first;
+  parser->first.includer = NULL;
+  parser->first.handle = NULL;
+}
 
-  set_defaults(parser);
-  result = parse(parser, user_data);
+void zone_parser_destroy(zone_parser_t *parser)
+{
+  if (!parser)
+    return;
+
+  // retained allocations were made using allocator of last parse
+  zone_parser_reset(parser);
+  release(parser);
+  free(parser);
+}
+
+int32_t zone_parser_parse(
+  zone_parser_t *parser,
+  const zone_options_t *options,
+  zone_buffers_t *buffers,
+  const char *path,
+  void *user_data)
+{
+  int32_t result;
+
+  assert(parser->cache.retain);
+  zone_parser_reset(parser);
+  if (!same_allocator(&parser->options.allocator, &options->allocator))
+    release(parser);
+  if ((result = open_zone(parser, options, buffers, path, user_data)) < 0)
+    return result;
+  result = parse_and_flush(parser, user_data);
   zone_close(parser);
   return result;
 }
+
+int32_t zone_parser_parse_string(
+  zone_parser_t *parser,
+  const zone_options_t *options,
+  zone_buffers_t *buffers,
+  const char *string,
+  size_t length,
+  void *user_data)
+{
+  int32_t result;
+
+  assert(parser->cache.retain);
+  zone_parser_reset(parser);
+  if (!same_allocator(&parser->options.allocator, &options->allocator))
+    release(parser);
+  if ((result = initialize(parser, options, buffers, user_data)) < 0)
+    return result;
+  if ((result = open_string(parser, string, length)) == 0) {
+    result = parse_and_flush(parser, user_data);
+    zone_close(parser);
+  }
+  close_string(parser);
+  return result;
+}